@@ -1,14 +1,28 @@
 #define ANKERL_NANOBENCH_IMPLEMENT
 #include "nanobench.hpp"
 
+#include <array>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <oryx/chron/crontab.hpp>
 #include <oryx/chron/parser.hpp>
+#include <oryx/chron/preprocessor.hpp>
 #include <oryx/chron/randomization.hpp>
+#include <oryx/chron/schedule.hpp>
+#include <oryx/chron/schedule_matcher.hpp>
+#include <oryx/chron/scheduler.hpp>
+#include <oryx/chron/task.hpp>
 
 #include <libcron/CronData.h>
 #include <libcron/CronRandomization.h>
 
 using namespace oryx::chron;
 using namespace ankerl;
+using namespace std::chrono;
 
 const std::string kRandomSchedule = "R(0-59) R(0-59) R(0-23) R(1-31) R(JAN-DEC) ?";
 
@@ -28,6 +42,318 @@ void bench(ankerl::nanobench::Bench* bench, char const* name) {
     });
 }
 
+void BenchPreprocessor() {
+    static constexpr std::array kExpressions{"0 */5 * * * ?", "0 0 12 ? JAN-JUN MON-FRI", "@daily"};
+
+    ankerl::nanobench::Bench b;
+    b.title("Preprocessing expressions").minEpochIterations(500000).relative(true).performanceCounters(true);
+    for (auto expr : kExpressions) {
+        Preprocessor<DollarExpressionProcessor, WeekMonthDayLiteralProcessor> preprocessor;
+        b.run(std::format("Preprocessor::Process \"{}\"", expr), [&] {
+            ankerl::nanobench::doNotOptimizeAway(preprocessor.Process(expr));
+        });
+        b.run(std::format("ExpressionParser \"{}\"", expr), [&] {
+            ankerl::nanobench::doNotOptimizeAway(kParseExpression(expr));
+        });
+    }
+}
+
+void BenchCalendarConversion() {
+    // Walk through time in steps that touch every calendar field
+    static constexpr auto kStep = days{1} + hours{1} + minutes{1} + seconds{1};
+    auto time = TimePoint{sys_days{2000y / 1 / 1}};
+
+    ankerl::nanobench::Bench b;
+    b.title("Calendar conversion").minEpochIterations(1000000).relative(true).performanceCounters(true);
+    b.run("std::chrono", [&] {
+        auto daypoint = floor<days>(time);
+        auto ymd = year_month_day(daypoint);
+        auto ymw = year_month_weekday(daypoint);
+        auto time_of_day = hh_mm_ss(time - daypoint);
+        nanobench::doNotOptimizeAway(ymd);
+        nanobench::doNotOptimizeAway(ymw);
+        nanobench::doNotOptimizeAway(time_of_day);
+        time += kStep;
+    });
+    b.run("Schedule::ToCalendarTime", [&] {
+        nanobench::doNotOptimizeAway(Schedule::ToCalendarTime(time));
+        time += kStep;
+    });
+}
+
+void BenchRearm() {
+    static constexpr std::array kExpressions{"* * * * * ?", "0 */5 * * * ?", "0 0 12 * * MON-FRI", "0 30 2 1 * ?"};
+
+    ankerl::nanobench::Bench b;
+    b.title("Re-arming a task after execution").minEpochIterations(200000).relative(true).performanceCounters(true);
+    for (auto expr : kExpressions) {
+        Schedule schedule(kParseExpression(expr).value());
+        auto next = schedule.CalculateFrom(sys_days{2024y / 1 / 1}).value();
+        b.run(std::format("Schedule::CalculateFrom \"{}\"", expr), [&] {
+            next = schedule.CalculateFrom(next + 1s).value();
+        });
+
+        Task task("bench", schedule, [](auto) {});
+        task.CalculateNext(sys_days{2024y / 1 / 1});
+        b.run(std::format("Task::CalculateNext \"{}\"", expr), [&] {
+            task.CalculateNext(task.GetNextSchedule() + 1s);
+        });
+    }
+}
+
+void BenchScheduleKinds() {
+    static constexpr std::array kExpressions{"*/15 * * * * ?", "0 */5 * * * ?", "0 30 2 * * ?", "0 0 8,12,18 * * ?",
+                                             "0 0 9 ? * MON-FRI"};
+
+    ankerl::nanobench::Bench b;
+    b.title("Next occurrence per schedule shape").minEpochIterations(1000000).relative(true).performanceCounters(true);
+    for (auto expr : kExpressions) {
+        auto masks = ChronMasks(kParseExpression(expr).value());
+        std::vector<Schedule> schedules;
+        // Day 0 of the month never comes up, allowing it keeps every occurrence but sends the schedule through
+        // the general search. Schedules on some weekdays would run on every day once they have days of month, they
+        // are only measured in their own shape.
+        if ((masks.weeks & ChronMasks::kAllWeekdays) == ChronMasks::kAllWeekdays) {
+            auto general_masks = masks;
+            general_masks.days |= 1;
+            schedules.emplace_back(general_masks);
+        }
+        schedules.emplace_back(masks);
+
+        for (const auto& schedule : schedules) {
+            auto kind = schedule.GetKind() == Schedule::Kind::General ? "general" : "shape";
+            auto next = schedule.CalculateFrom(sys_days{2024y / 1 / 1}).value();
+            b.run(std::format("Schedule::CalculateFrom \"{}\" ({})", expr, kind), [&] {
+                next = schedule.CalculateFrom(next + 1s).value();
+            });
+
+            Task task("bench", schedule, [](auto) {});
+            task.CalculateNext(sys_days{2024y / 1 / 1});
+            b.run(std::format("Task::CalculateNext \"{}\" ({})", expr, kind), [&] {
+                task.CalculateNext(task.GetNextSchedule() + 1s);
+            });
+        }
+    }
+}
+
+void BenchOccurrences() {
+    Schedule schedule(kParseExpression("0 */5 9-17 * * MON-FRI").value());
+    auto from = sys_days{2024y / 1 / 1};
+    std::array<TimePoint, 1000> out{};
+
+    ankerl::nanobench::Bench b;
+    b.title("Next 1000 occurrences").relative(true).performanceCounters(true);
+    b.run("Schedule::CalculateFrom", [&] {
+        auto next = schedule.CalculateFrom(from);
+        for (auto& time : out) {
+            time = next.value();
+            next = schedule.CalculateFrom(time + 1s);
+        }
+        ankerl::nanobench::doNotOptimizeAway(out);
+    });
+    b.run("Schedule::NextN", [&] {
+        schedule.NextN(from, out);
+        ankerl::nanobench::doNotOptimizeAway(out);
+    });
+    b.run("Schedule::Occurrences", [&] {
+        auto it = out.begin();
+        for (auto time : schedule.Occurrences(from, TimePoint::max())) {
+            *it = time;
+            if (++it == out.end()) break;
+        }
+        ankerl::nanobench::doNotOptimizeAway(out);
+    });
+}
+
+void BenchPrevious() {
+    static constexpr std::array kExpressions{"0 */5 * * * ?", "0 0 12 * * MON-FRI", "0 30 2 1 * ?"};
+
+    ankerl::nanobench::Bench b;
+    b.title("Latest occurrence before a point in time").relative(true).performanceCounters(true);
+    for (auto expr : kExpressions) {
+        Schedule schedule(kParseExpression(expr).value());
+        TimePoint at = sys_days{2024y / 6 / 15} + 13h + 7min;
+        b.run(std::format("Schedule::CalculatePrevious \"{}\"", expr), [&] {
+            ankerl::nanobench::doNotOptimizeAway(schedule.CalculatePrevious(at));
+        });
+    }
+}
+
+void BenchScheduleMatcher() {
+    static constexpr std::size_t kSchedules = 1'000'000;
+
+    std::mt19937 rng{42};
+    std::vector<Schedule> schedules;
+    schedules.reserve(kSchedules);
+    for (std::size_t i = 0; i < 1000; ++i) {
+        auto first_day = rng() % 7;
+        auto last_day = first_day + rng() % (7 - first_day);
+        auto expr = std::format("0 {}/15 {}/6 ? * {}-{}", rng() % 15, rng() % 6, first_day, last_day);
+        schedules.emplace_back(kParseExpression(expr).value());
+    }
+    while (schedules.size() < kSchedules) schedules.push_back(schedules[schedules.size() % 1000]);
+
+    ScheduleMatcher matcher;
+    matcher.Reserve(kSchedules);
+    for (const auto& schedule : schedules) matcher.Add(schedule);
+
+    TimePoint time = sys_days{2024y / 6 / 14} + 12h + 30min;
+    std::vector<uint64_t> bitmap;
+
+    ankerl::nanobench::Bench b;
+    b.title("Which of 1M schedules fire at an instant").relative(true).minEpochIterations(3);
+    b.run("Schedule::CalculateFrom for each schedule", [&] {
+        std::size_t count = 0;
+        for (const auto& schedule : schedules) count += schedule.CalculateFrom(time) == time;
+        ankerl::nanobench::doNotOptimizeAway(count);
+    });
+    b.run("ScheduleMatcher::Match", [&] {
+        matcher.Match(time, bitmap);
+        ankerl::nanobench::doNotOptimizeAway(bitmap);
+    });
+}
+
+class ManualClock {
+public:
+    auto Now() const -> TimePoint { return now_; }
+    auto UtcOffset(TimePoint) const -> seconds { return 0s; }
+    void Advance(Duration duration) { now_ += duration; }
+
+private:
+    TimePoint now_{sys_days{2024y / 1 / 1}};
+};
+
+void BenchClockJump() {
+    static constexpr std::size_t kTasks = 200'000;
+
+    ankerl::nanobench::Bench b;
+    b.title("Tick right after the clock moved back by 5h").relative(true).minEpochIterations(5);
+    for (auto budget : {std::numeric_limits<std::size_t>::max(), Scheduler<ManualClock>::kDefaultRecalculationBudget}) {
+        Scheduler<ManualClock> scheduler;
+        scheduler.SetRecalculationBudget(budget);
+        scheduler.AddScheduleBatch(
+            [](auto add) {
+                for (std::size_t i = 0; i < kTasks; ++i) {
+                    add(std::format("task {}", i), std::format("{} {} {}/4 * * ?", i % 60, i / 60 % 60, i % 4),
+                        [](auto) {});
+                }
+            },
+            kTasks);
+        scheduler.Tick();
+
+        auto name = budget == std::numeric_limits<std::size_t>::max() ? std::string("Recalculate all")
+                                                                      : std::format("Recalculate {} per tick", budget);
+        b.run(name, [&] {
+            scheduler.GetClock().Advance(-5h);
+            ankerl::nanobench::doNotOptimizeAway(scheduler.Tick());
+        });
+    }
+}
+
+void BenchBulkLoad() {
+    static constexpr std::size_t kTasks = 50'000;
+
+    auto add_all = [](auto add) {
+        for (std::size_t i = 0; i < kTasks; ++i) {
+            add(std::format("task {}", i), std::format("{} {} {}/4 * * ?", i % 60, i / 60 % 60, i % 4), [](auto) {});
+        }
+    };
+
+    ankerl::nanobench::Bench b;
+    b.title("Loading 50k tasks").relative(true).epochs(3);
+    b.run("Scheduler::AddScheduleBatch", [&] {
+        Scheduler<ManualClock> scheduler;
+        scheduler.AddScheduleBatch(add_all, kTasks);
+    });
+    b.run("Scheduler::AddScheduleBatchParallel", [&] {
+        Scheduler<ManualClock> scheduler;
+        scheduler.AddScheduleBatchParallel(add_all, kTasks);
+    });
+}
+
+void BenchCrontab() {
+    static constexpr std::size_t kLines = 1'000'000;
+
+    auto path = std::filesystem::temp_directory_path() / "chron_bench_crontab.txt";
+    {
+        std::ofstream file(path, std::ios::trunc);
+        for (std::size_t i = 0; i < kLines; ++i) {
+            file << std::format("task{} {} {} {}/4 * * ?\n", i, i % 60, i / 60 % 60, i % 4);
+        }
+    }
+
+    ankerl::nanobench::Bench b;
+    b.title("Loading a crontab with 1M lines").relative(true).epochs(1);
+    b.run("Crontab::ForEach", [&] {
+        std::size_t count = 0;
+        Crontab::Open(path)->ForEach([&count](const auto&) { count++; });
+        ankerl::nanobench::doNotOptimizeAway(count);
+    });
+    b.run("Scheduler::AddCrontab", [&] {
+        Scheduler<ManualClock> scheduler;
+        ankerl::nanobench::doNotOptimizeAway(scheduler.AddCrontab(Crontab::Open(path).value(), [](auto) {}));
+    });
+    b.run("CScheduler::AddCrontab", [&] {
+        CScheduler<ManualClock> scheduler;
+        ankerl::nanobench::doNotOptimizeAway(scheduler.AddCrontab(Crontab::Open(path).value(), [](auto) {}));
+    });
+
+    std::filesystem::remove(path);
+}
+
+void BenchSnapshot() {
+    static constexpr std::size_t kTasks = 1'000'000;
+
+    auto path = std::filesystem::temp_directory_path() / "chron_bench_snapshot.bin";
+    CScheduler<ManualClock> scheduler;
+    scheduler.AddScheduleBatch(
+        [](auto add_schedule) {
+            for (std::size_t i = 0; i < kTasks; ++i) {
+                add_schedule(std::format("task{}", i), std::format("{} {} {}/4 * * ?", i % 60, i / 60 % 60, i % 4),
+                             [](auto) {});
+            }
+        },
+        kTasks);
+
+    auto registry = [](std::string_view) -> TaskFn { return [](auto) {}; };
+
+    ankerl::nanobench::Bench b;
+    b.title("Snapshot of 1M tasks").relative(true).epochs(1);
+    b.run("Scheduler::SaveSnapshot", [&] { ankerl::nanobench::doNotOptimizeAway(scheduler.SaveSnapshot(path)); });
+    b.run("Scheduler::RestoreSnapshot", [&] {
+        Scheduler<ManualClock> restored;
+        ankerl::nanobench::doNotOptimizeAway(restored.RestoreSnapshot(path, registry));
+    });
+
+    std::filesystem::remove(path);
+}
+
+void BenchJournal() {
+    static constexpr std::size_t kTasks = 10'000;
+
+    auto path = std::filesystem::temp_directory_path() / "chron_bench_journal.log";
+    auto run = [&](ankerl::nanobench::Bench& b, const char* name, bool journal) {
+        std::filesystem::remove(path);
+        Scheduler<ManualClock> scheduler;
+        scheduler.AddScheduleBatch([](auto add_schedule) {
+            for (std::size_t i = 0; i < kTasks; ++i) add_schedule(std::format("task{}", i), "* * * * * ?", [](auto) {});
+        });
+        if (journal) scheduler.OpenJournal(path);
+
+        b.run(name, [&] {
+            scheduler.GetClock().Advance(1s);
+            ankerl::nanobench::doNotOptimizeAway(scheduler.Tick());
+        });
+    };
+
+    ankerl::nanobench::Bench b;
+    b.title("Firing 10k tasks per tick").unit("fire").batch(kTasks).relative(true).minEpochIterations(20);
+    run(b, "without journal", false);
+    run(b, "with journal", true);
+
+    std::filesystem::remove(path);
+}
+
 auto main() -> int {
     static const auto kCachedParse = CachedExpressionParser();
     static const auto kMtx = CachedExpressionParser<std::mutex>();
@@ -53,4 +379,30 @@ auto main() -> int {
         auto r = rng2.parse(kRandomSchedule);
         nanobench::doNotOptimizeAway(r);
     });
-}
\ No newline at end of file
+
+    // Drawing from a template skips the expression text on both ends.
+    auto pattern = RandomizationTemplate::Parse(kRandomSchedule).value();
+    b2.run("chron-cpp Parse + ExpressionParser", [&] {
+        nanobench::doNotOptimizeAway(Schedule(kParseExpression(rng1.Parse(kRandomSchedule).value()).value()));
+    });
+    b2.run("chron-cpp Generate", [&] { nanobench::doNotOptimizeAway(Schedule(rng1.Generate(pattern).value())); });
+    Occupancy occupancy;
+    b2.run("chron-cpp Place", [&] { nanobench::doNotOptimizeAway(Schedule(rng1.Place(pattern, occupancy).value())); });
+    BasicRandomization<std::mt19937> twister;
+    b2.run("chron-cpp Generate with std::mt19937", [&] {
+        nanobench::doNotOptimizeAway(Schedule(twister.Generate(pattern).value()));
+    });
+
+    BenchPreprocessor();
+    BenchCalendarConversion();
+    BenchRearm();
+    BenchScheduleKinds();
+    BenchOccurrences();
+    BenchPrevious();
+    BenchScheduleMatcher();
+    BenchClockJump();
+    BenchBulkLoad();
+    BenchCrontab();
+    BenchSnapshot();
+    BenchJournal();
+}
@@ -1,20 +1,48 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <set>
+#include <string>
+#include <utility>
 
+#include "common.hpp"
 #include "time_types.hpp"
 
 namespace oryx::chron {
 
-struct ChronData {
+struct ORYX_CHRON_API ChronData {
     ChronData() = default;
 
+    auto operator==(const ChronData&) const -> bool = default;
+
+    // The one expression every spelling of this schedule maps to, see `ChronMasks::ToCanonicalString`.
+    auto ToCanonicalString() const -> std::string;
+
     std::set<Seconds> seconds;
     std::set<Minutes> minutes;
     std::set<Hours> hours;
     std::set<MonthDays> days;
     std::set<Weekdays> weeks;
     std::set<Months> months;
+    // Empty when the expression has no year field or allows every year of it.
+    std::set<Years> years;
+
+    // Quartz style day of month entries: `L` and `L-n` as days before the last day of the month (0 for `L`), `nW`
+    // as the weekday nearest to day `n` and `LW` as the last weekday of the month.
+    std::set<uint8_t> last_day_offsets;
+    std::set<MonthDays> nearest_weekdays;
+    bool last_weekday{};
+
+    // Quartz style day of week entries: `dL` as the last weekday `d` of the month and `d#n` as its `n`th one.
+    std::set<Weekdays> last_weekdays;
+    std::set<std::pair<Weekdays, uint8_t>> nth_weekdays;
 };
 
-}  // namespace oryx::chron
\ No newline at end of file
+}  // namespace oryx::chron
+
+// Hashes the field masks, equal schedules hash the same no matter how they were written.
+template <>
+struct ORYX_CHRON_API std::hash<oryx::chron::ChronData> {
+    auto operator()(const oryx::chron::ChronData& data) const noexcept -> std::size_t;
+};
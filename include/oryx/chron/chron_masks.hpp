@@ -0,0 +1,248 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "common.hpp"
+#include "chron_data.hpp"
+#include "time_types.hpp"
+#include "details/civil.hpp"
+#include "details/to_underlying.hpp"
+
+namespace oryx::chron {
+
+// Compact form of `ChronData`: bit `n` of a mask is set when the value `n` is part of the field.
+struct ORYX_CHRON_API ChronMasks {
+    ChronMasks() = default;
+
+    explicit ChronMasks(const ChronData& data)
+        : seconds(ToMask<uint64_t>(data.seconds)),
+          minutes(ToMask<uint64_t>(data.minutes)),
+          hours(ToMask<uint32_t>(data.hours)),
+          days(ToMask<uint32_t>(data.days)),
+          months(ToMask<uint16_t>(data.months)),
+          weeks(ToMask<uint8_t>(data.weeks)),
+          last_weekdays(ToMask<uint8_t>(data.last_weekdays)),
+          last_day_offsets(ToMask<uint32_t>(data.last_day_offsets)),
+          nearest_weekdays(ToMask<uint32_t>(data.nearest_weekdays) | uint32_t{data.last_weekday}),
+          nth_weekdays(ToNthWeekdayMask(data.nth_weekdays)),
+          years(ToYearMask(data.years)) {}
+
+    auto operator==(const ChronMasks&) const -> bool = default;
+
+    // Day of month takes precedence over day of week unless all days are allowed.
+    constexpr auto HasMonthDays() const -> bool {
+        return days != kAllMonthDays || last_day_offsets != 0 || nearest_weekdays != 0;
+    }
+
+    // Whether any of the Quartz style entries that depend on the length or the weekdays of a month is used.
+    constexpr auto HasSpecialDays() const -> bool {
+        return last_day_offsets != 0 || nearest_weekdays != 0 || last_weekdays != 0 || nth_weekdays != 0;
+    }
+
+    // Whether the year field restricts the schedule, years outside of its range are never allowed then.
+    constexpr auto HasYears() const -> bool { return years != kAllYears; }
+
+    constexpr auto HasYear(int year) const -> bool {
+        if (!HasYears()) {
+            return true;
+        }
+        if (year < kFirstYear || year > kLastYear) {
+            return false;
+        }
+        auto bit = static_cast<unsigned>(year - kFirstYear);
+        return (years[bit / 64] >> (bit % 64) & 1u) != 0;
+    }
+
+    // First allowed year after `year`, nothing once the year field runs out.
+    constexpr auto NextYear(int year) const -> std::optional<int> {
+        for (auto next = year < kFirstYear ? kFirstYear : year + 1; next <= kLastYear; ++next) {
+            if (HasYear(next)) return next;
+        }
+        return HasYears() ? std::nullopt : std::optional<int>(year + 1);
+    }
+
+    // Last allowed year before `year`.
+    constexpr auto PrevYear(int year) const -> std::optional<int> {
+        for (auto prev = year > kLastYear ? kLastYear : year - 1; prev >= kFirstYear; --prev) {
+            if (HasYear(prev)) return prev;
+        }
+        return HasYears() ? std::nullopt : std::optional<int>(year - 1);
+    }
+
+    // Days of the given month the schedule runs on, bit `n` stands for day `n`.
+    constexpr auto GetMonthDays(int year, unsigned month) const -> uint32_t {
+        auto first = static_cast<unsigned>(details::CivilFromDays(details::DaysFromCivil(year, month, 1)).weekday);
+        return GetMonthDays(year, month, first, details::LastDayOfMonth(year, month));
+    }
+
+    // Same as above for callers that already know the weekday of the first and the length of the month.
+    constexpr auto GetMonthDays(int year, unsigned month, unsigned first_weekday, unsigned last_day) const
+        -> uint32_t {
+        if (!(months >> month & 1u) || !HasYear(year)) {
+            return 0;
+        }
+
+        auto weekday_of = [first_weekday](unsigned day) { return (first_weekday + day - 1) % 7; };
+        auto valid = kAllMonthDays & (~uint32_t{0} >> (31 - last_day));
+        if (HasMonthDays()) {
+            auto month_days = days & valid;
+            for (auto offsets = last_day_offsets; offsets != 0; offsets &= offsets - 1) {
+                auto offset = static_cast<unsigned>(std::countr_zero(offsets));
+                if (offset < last_day) month_days |= uint32_t{1} << (last_day - offset);
+            }
+            // Bit 0 stands for `LW`, which is the weekday nearest to the last day.
+            for (auto nearest = nearest_weekdays; nearest != 0; nearest &= nearest - 1) {
+                auto day = static_cast<unsigned>(std::countr_zero(nearest));
+                day = day == 0 ? last_day : day;
+                if (day <= last_day) month_days |= uint32_t{1} << NearestWeekday(day, weekday_of(day), last_day);
+            }
+            return month_days;
+        }
+
+        // Weekdays are rotated so that bit 0 stands for the first of the month and then repeated for every week.
+        auto week = static_cast<uint64_t>((weeks >> first_weekday | weeks << (7 - first_weekday)) & kAllWeekdays);
+        auto month_days = static_cast<uint32_t>((week | week << 7 | week << 14 | week << 21 | week << 28) << 1) & valid;
+
+        auto last_weekday = weekday_of(last_day);
+        for (auto last = last_weekdays; last != 0; last &= last - 1) {
+            auto weekday = static_cast<unsigned>(std::countr_zero(last));
+            month_days |= uint32_t{1} << (last_day - (last_weekday + 7 - weekday) % 7);
+        }
+        for (auto nth = nth_weekdays; nth != 0; nth &= nth - 1) {
+            auto bit = static_cast<unsigned>(std::countr_zero(nth));
+            auto day = 1 + (bit % 7 + 7 - first_weekday) % 7 + 7 * (bit / 7);
+            if (day <= last_day) month_days |= uint32_t{1} << day;
+        }
+        return month_days;
+    }
+
+    // Whether the schedule runs at all.
+    constexpr auto IsSatisfiable() const -> bool {
+        if (!seconds || !minutes || !hours) {
+            return false;
+        }
+        if (!HasSpecialDays() && !HasYears()) {
+            if (!(weeks & kAllWeekdays)) {
+                return false;
+            }
+            // Only days past the end of a month rule it out, February counts with its 29th day.
+            return ((months & ~(kFebruary | kMonthsWith30)) != 0 && days != 0) ||
+                   ((months & kMonthsWith30) != 0 && (days & 0x7FFF'FFFF) != 0) ||
+                   ((months & kFebruary) != 0 && (days & 0x3FFF'FFFF) != 0);
+        }
+
+        // Every month starts on every weekday, in both its common and its leap year length, within the 28 years
+        // from 2000 on. A year field is searched as a whole.
+        auto first = HasYears() ? kFirstYear : 2000;
+        auto last = HasYears() ? kLastYear : 2027;
+        for (auto year = first; year <= last; ++year) {
+            if (!HasYear(year)) continue;
+            for (unsigned month = 1; month <= 12; ++month) {
+                if (GetMonthDays(year, month) != 0) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Numeric expression with `*` for complete fields, `?` for the ignored day field, `start/step` for steps that
+    // run up to the end of a field and ranges or lists otherwise. Quartz style entries follow the numeric ones of
+    // their field and the year field is only there when it restricts the schedule. Parsing it gives back the same
+    // masks.
+    auto ToCanonicalString() const -> std::string;
+
+    static constexpr uint32_t kAllMonthDays = 0xFFFF'FFFE;
+    static constexpr uint8_t kAllWeekdays = 0x7F;
+    // Months with fewer than 31 days.
+    static constexpr uint16_t kFebruary = 1 << 2;
+    static constexpr uint16_t kMonthsWith30 = 1 << 4 | 1 << 6 | 1 << 9 | 1 << 11;
+    static constexpr int kFirstYear = details::to_underlying(Years::First);
+    static constexpr int kLastYear = details::to_underlying(Years::Last);
+    // Bit `n` stands for year `kFirstYear + n`.
+    static constexpr std::array<uint64_t, 3> kAllYears{~uint64_t{0}, ~uint64_t{0}, 0x3};
+
+    uint64_t seconds{};
+    uint64_t minutes{};
+    uint32_t hours{};
+    uint32_t days{};
+    uint16_t months{};
+    uint8_t weeks{};
+    // Bit `d` for `dL`.
+    uint8_t last_weekdays{};
+    // Bit `n` for `L-n`.
+    uint32_t last_day_offsets{};
+    // Bit `n` for `nW`, bit 0 for `LW`.
+    uint32_t nearest_weekdays{};
+    // Bit `7 * (n - 1) + d` for `d#n`.
+    uint64_t nth_weekdays{};
+    std::array<uint64_t, 3> years{kAllYears};
+
+private:
+    template <typename Mask, typename T>
+    static auto ToMask(const std::set<T>& values) -> Mask {
+        Mask mask{};
+        for (auto value : values) {
+            if constexpr (std::is_enum_v<T>) {
+                mask |= static_cast<Mask>(Mask{1} << details::to_underlying(value));
+            } else {
+                mask |= static_cast<Mask>(Mask{1} << value);
+            }
+        }
+        return mask;
+    }
+
+    static auto ToNthWeekdayMask(const std::set<std::pair<Weekdays, uint8_t>>& values) -> uint64_t {
+        uint64_t mask{};
+        for (auto [weekday, nth] : values) mask |= uint64_t{1} << (7 * (nth - 1) + details::to_underlying(weekday));
+        return mask;
+    }
+
+    static auto ToYearMask(const std::set<Years>& values) -> std::array<uint64_t, 3> {
+        if (values.empty()) {
+            return kAllYears;
+        }
+        std::array<uint64_t, 3> mask{};
+        for (auto value : values) {
+            auto bit = static_cast<unsigned>(details::to_underlying(value) - kFirstYear);
+            mask[bit / 64] |= uint64_t{1} << (bit % 64);
+        }
+        return mask;
+    }
+
+    // Saturdays move back to Friday and Sundays ahead to Monday, without leaving the month.
+    static constexpr auto NearestWeekday(unsigned day, unsigned weekday, unsigned last_day) -> unsigned {
+        if (weekday == 6) return day == 1 ? 3 : day - 1;
+        if (weekday == 0) return day == last_day ? day - 2 : day + 1;
+        return day;
+    }
+};
+
+}  // namespace oryx::chron
+
+template <>
+struct std::hash<oryx::chron::ChronMasks> {
+    auto operator()(const oryx::chron::ChronMasks& masks) const noexcept -> std::size_t {
+        // Each field is spread over the whole word before they are combined, then the bits are mixed once more.
+        auto hash = masks.seconds * 0x9E3779B97F4A7C15;
+        hash ^= (masks.minutes + (hash << 6) + (hash >> 2)) * 0xC2B2AE3D27D4EB4F;
+        hash ^= ((uint64_t{masks.hours} << 32 | masks.days) + (hash << 6) + (hash >> 2)) * 0x165667B19E3779F9;
+        hash ^= ((uint64_t{masks.months} << 8 | masks.weeks) + (hash << 6) + (hash >> 2)) * 0x27D4EB2F165667C5;
+        if (masks.HasSpecialDays() || masks.HasYears()) [[unlikely]] {
+            auto special = uint64_t{masks.last_day_offsets} << 32 | masks.nearest_weekdays;
+            special ^= masks.nth_weekdays * 0x9E3779B97F4A7C15 + masks.last_weekdays;
+            special ^= (masks.years[0] + masks.years[1] * 0xC2B2AE3D27D4EB4F + masks.years[2]) * 0x165667B19E3779F9;
+            hash ^= (special + (hash << 6) + (hash >> 2)) * 0x27D4EB2F165667C5;
+        }
+        return static_cast<std::size_t>(hash ^ (hash >> 32));
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "common.hpp"
+#include "details/mapped_file.hpp"
+
+namespace oryx::chron {
+
+struct CrontabError {
+    std::size_t line;
+    // Byte offset of the start of the line within the file.
+    std::size_t offset;
+    std::string message;
+};
+
+// Read only view of a crontab file with one `<name> <expression>` per line. Empty lines and lines starting with `#`
+// are ignored. The file is memory mapped, names and expressions point straight into the mapping.
+class ORYX_CHRON_API Crontab {
+public:
+    struct Entry {
+        std::string_view name;
+        std::string_view expression;
+        std::size_t line;
+        std::size_t offset;
+    };
+
+    static auto Open(const std::filesystem::path& path) -> std::optional<Crontab> {
+        auto file = details::MappedFile::Open(path);
+        if (!file) {
+            return std::nullopt;
+        }
+        return Crontab(std::move(file.value()));
+    }
+
+    auto GetData() const -> std::string_view { return file_.GetData(); }
+
+    // Calls `fn(entry)` for each line holding a task, in file order.
+    template <typename F>
+    void ForEach(F&& fn) const {
+        auto data = GetData();
+        std::size_t line = 0;
+        for (std::size_t offset = 0; offset < data.size(); ++line) {
+            auto end = data.find('\n', offset);
+            if (end == std::string_view::npos) end = data.size();
+            auto text = Trim(data.substr(offset, end - offset));
+
+            if (!text.empty() && text.front() != '#') {
+                auto name_end = text.find_first_of(kBlanks);
+                auto name = text.substr(0, name_end);
+                auto expression = name_end == std::string_view::npos ? std::string_view{} : Trim(text.substr(name_end));
+                fn(Entry{.name = name, .expression = expression, .line = line + 1, .offset = offset});
+            }
+            offset = end + 1;
+        }
+    }
+
+private:
+    static constexpr std::string_view kBlanks = " \t\r";
+
+    explicit Crontab(details::MappedFile file)
+        : file_(std::move(file)) {}
+
+    static auto Trim(std::string_view text) -> std::string_view {
+        auto first = text.find_first_not_of(kBlanks);
+        if (first == std::string_view::npos) return {};
+        return text.substr(first, text.find_last_not_of(kBlanks) - first + 1);
+    }
+
+    details::MappedFile file_;
+};
+
+}  // namespace oryx::chron
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "crontab.hpp"
+#include "task.hpp"
+#include "details/file_watcher.hpp"
+
+namespace oryx::chron {
+
+// Keeps the tasks of a scheduler in line with a crontab file. Reloading compares the entries of the file with the
+// ones loaded before by name and expression, and only adds, removes or replaces the tasks that differ. Tasks
+// of unchanged entries keep their state. Other tasks of the scheduler are left alone, as long as their names do not
+// clash with entries of the file.
+template <typename SchedulerType>
+class CrontabWatcher {
+public:
+    CrontabWatcher(SchedulerType& scheduler, std::filesystem::path path, TaskFn work)
+        : scheduler_(scheduler),
+          path_(std::move(path)),
+          work_(std::move(work)),
+          watcher_(path_) {}
+
+    // Reloads the file if it changed since the last call. Returns the errors of the reload, or `std::nullopt` if
+    // nothing changed.
+    auto Poll() -> std::optional<std::vector<CrontabError>> {
+        if (!watcher_.HasChanged()) {
+            return std::nullopt;
+        }
+        return Reload();
+    }
+
+    // Applies the current content of the file. If it can not be opened, e.g. while it is being replaced, all tasks
+    // are kept.
+    auto Reload() -> std::vector<CrontabError> {
+        std::vector<CrontabError> errors;
+        auto crontab = Crontab::Open(path_);
+        if (!crontab) [[unlikely]] {
+            errors.emplace_back(0, 0, "unable to open '" + path_.string() + "'");
+            return errors;
+        }
+
+        std::unordered_set<std::string_view> names;
+        crontab->ForEach([&names](const Crontab::Entry& entry) { names.insert(entry.name); });
+
+        std::unordered_set<std::string_view> removed;
+        for (const auto& [name, expression] : loaded_) {
+            if (!names.contains(name)) removed.insert(name);
+        }
+
+        std::unordered_map<std::string, LoadedExpression> loaded;
+        scheduler_.UpdateSchedules(removed, [&](auto add_schedule) {
+            crontab->ForEach([&](const Crontab::Entry& entry) {
+                auto name = std::string(entry.name);
+                if (loaded.contains(name)) [[unlikely]] {
+                    errors.emplace_back(entry.line, entry.offset, "duplicate name '" + name + "'");
+                    return;
+                }
+
+                auto previous = loaded_.find(name);
+                auto hash = hash_(entry.expression);
+                // Hashes rule most changes out cheaply, the text decides when they match.
+                if (previous != loaded_.end() && previous->second.hash == hash &&
+                    previous->second.text == entry.expression) {
+                    loaded.emplace(std::move(name), std::move(previous->second));
+                    return;
+                }
+
+                if (entry.expression.empty()) [[unlikely]] {
+                    errors.emplace_back(entry.line, entry.offset, "missing expression");
+                } else if (add_schedule(name, entry.expression, work_)) [[likely]] {
+                    loaded.emplace(std::move(name), LoadedExpression{hash, std::string(entry.expression)});
+                    return;
+                } else {
+                    errors.emplace_back(entry.line, entry.offset,
+                                        "invalid expression '" + std::string(entry.expression) + "'");
+                }
+
+                // The task loaded before stays in place until the entry is fixed.
+                if (previous != loaded_.end()) loaded.emplace(std::move(name), std::move(previous->second));
+            });
+        });
+
+        loaded_ = std::move(loaded);
+        return errors;
+    }
+
+    auto GetPath() const -> const std::filesystem::path& { return path_; }
+
+private:
+    struct LoadedExpression {
+        std::size_t hash;
+        std::string text;
+    };
+
+    SchedulerType& scheduler_;
+    std::filesystem::path path_;
+    TaskFn work_;
+    details::FileWatcher watcher_;
+    std::hash<std::string_view> hash_{};
+    // Name and expression of every entry that has a task in the scheduler.
+    std::unordered_map<std::string, LoadedExpression> loaded_;
+};
+
+}  // namespace oryx::chron
@@ -11,6 +11,7 @@ struct DateTime {
     uint8_t hour = 0;
     uint8_t min = 0;
     uint8_t sec = 0;
+    uint8_t weekday = 0;  // 0 = Sunday
 };
 
 }  // namespace oryx::chron
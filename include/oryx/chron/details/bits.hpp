@@ -0,0 +1,33 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <limits>
+
+namespace oryx::chron::details {
+
+// Position of the lowest set bit at or above `from`, the bit width of `T` if there is none.
+template <std::unsigned_integral T>
+constexpr auto NextBit(T mask, unsigned from) -> unsigned {
+    constexpr auto kWidth = static_cast<unsigned>(std::numeric_limits<T>::digits);
+    if (from >= kWidth) {
+        return kWidth;
+    }
+    return static_cast<unsigned>(std::countr_zero(static_cast<T>(mask & static_cast<T>(~T{0} << from))));
+}
+
+// Position of the highest set bit at or below `from`, the bit width of `T` if there is none.
+template <std::unsigned_integral T>
+constexpr auto PrevBit(T mask, unsigned from) -> unsigned {
+    constexpr auto kWidth = static_cast<unsigned>(std::numeric_limits<T>::digits);
+    if (from >= kWidth) {
+        from = kWidth - 1;
+    }
+    auto below = static_cast<T>(mask & static_cast<T>(static_cast<T>(~T{0}) >> (kWidth - 1 - from)));
+    if (below == 0) {
+        return kWidth;
+    }
+    return kWidth - 1 - static_cast<unsigned>(std::countl_zero(below));
+}
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+
+namespace oryx::chron::details {
+
+struct CivilDate {
+    int year;
+    unsigned month;
+    unsigned day;
+    unsigned weekday;  // 0 = Sunday
+};
+
+constexpr auto IsLeapYear(int year) -> bool { return (year % 4 == 0) & ((year % 100 != 0) | (year % 400 == 0)); }
+
+constexpr auto LastDayOfMonth(int year, unsigned month) -> unsigned {
+    // 31 for months whose number parity flips after July, Februaries are fixed up without a branch.
+    auto last = 30u | ((month ^ (month >> 3)) & 1u);
+    auto is_february = static_cast<unsigned>(month == 2);
+    return last - is_february * (last - 28u - static_cast<unsigned>(IsLeapYear(year)));
+}
+
+// Days since 1970-01-01 to year, month, day and weekday in a single pass.
+// http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+constexpr auto CivilFromDays(int64_t days) -> CivilDate {
+    const auto weekday = static_cast<unsigned>((days % 7 + 11) % 7);
+
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned month = mp + 3 - 12 * static_cast<unsigned>(mp >= 10);
+    const auto year = static_cast<int>(yoe + era * 400 + static_cast<int64_t>(month <= 2));
+    return {.year = year, .month = month, .day = day, .weekday = weekday};
+}
+
+// http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+constexpr auto DaysFromCivil(int year, unsigned month, unsigned day) -> int64_t {
+    year -= static_cast<int>(month <= 2);
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month + 9 - 12 * static_cast<unsigned>(month > 2)) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Walks through the calendar day by day, keeping the civil date up to date instead of deriving it again.
+class DayCursor {
+public:
+    constexpr explicit DayCursor(int64_t days)
+        : days_(days),
+          date_(CivilFromDays(days)),
+          last_day_(LastDayOfMonth(date_.year, date_.month)) {}
+
+    constexpr void NextDay() {
+        if (date_.day == last_day_) {
+            NextMonth();
+            return;
+        }
+        ++days_;
+        ++date_.day;
+        date_.weekday = (date_.weekday + 1) % 7;
+    }
+
+    constexpr void PrevDay() {
+        if (date_.day == 1) {
+            PrevMonth();
+            return;
+        }
+        --days_;
+        --date_.day;
+        date_.weekday = (date_.weekday + 6) % 7;
+    }
+
+    // Moves to another day of the current month.
+    constexpr void SetDay(unsigned day) {
+        auto delta = static_cast<int>(day) - static_cast<int>(date_.day);
+        days_ += delta;
+        date_.day = day;
+        date_.weekday = static_cast<unsigned>(static_cast<int>(date_.weekday) + 35 + delta) % 7;
+    }
+
+    // Moves ahead by less than four weeks, which crosses at most one month boundary.
+    constexpr void AddDays(unsigned count) {
+        if (date_.day + count > last_day_) {
+            count -= last_day_ - date_.day + 1;
+            NextMonth();
+        }
+        SetDay(date_.day + count);
+    }
+
+    // Moves to the first day of the following month.
+    constexpr void NextMonth() {
+        auto remaining = last_day_ - date_.day + 1;
+        days_ += remaining;
+        date_.weekday = (date_.weekday + remaining) % 7;
+        date_.day = 1;
+        if (date_.month == 12) {
+            date_.month = 1;
+            ++date_.year;
+        } else {
+            ++date_.month;
+        }
+        last_day_ = LastDayOfMonth(date_.year, date_.month);
+    }
+
+    // Moves to the last day of the preceding month.
+    constexpr void PrevMonth() {
+        days_ -= date_.day;
+        date_.weekday = (date_.weekday + 35 - date_.day) % 7;
+        if (date_.month == 1) {
+            date_.month = 12;
+            --date_.year;
+        } else {
+            --date_.month;
+        }
+        last_day_ = LastDayOfMonth(date_.year, date_.month);
+        date_.day = last_day_;
+    }
+
+    constexpr auto GetDays() const -> int64_t { return days_; }
+    constexpr auto GetDate() const -> const CivilDate& { return date_; }
+    constexpr auto GetLastDayOfMonth() const -> unsigned { return last_day_; }
+
+private:
+    int64_t days_;
+    CivilDate date_;
+    unsigned last_day_;
+};
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#include "../common.hpp"
+
+namespace oryx::chron::details {
+
+// Unbuffered writes through the file descriptors of the platform, for files that have to survive a power loss.
+// Files are opened for appending, negative descriptors stand for errors.
+ORYX_CHRON_API auto OpenFile(const std::filesystem::path& path, bool truncate) -> int;
+ORYX_CHRON_API auto WriteFile(int file, const void* data, std::size_t size) -> bool;
+ORYX_CHRON_API auto SyncFile(int file) -> bool;
+ORYX_CHRON_API auto TruncateFile(int file, std::size_t size) -> bool;
+ORYX_CHRON_API void CloseFile(int file);
+
+// Makes the entries of `directory` durable, such as a file created or renamed in it. Nothing to do on Windows,
+// which has no way to sync a directory.
+ORYX_CHRON_API auto SyncDirectory(const std::filesystem::path& directory) -> bool;
+
+// Moves the synced file `temporary` over `path`. After a crash either the old or the new file is found at `path`,
+// never a part of the new one.
+ORYX_CHRON_API auto ReplaceFile(const std::filesystem::path& temporary, const std::filesystem::path& path) -> bool;
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "../common.hpp"
+
+namespace oryx::chron::details {
+
+// Notices when a file is written, replaced or removed. Uses inotify on Linux and compares the modification time and
+// size of the file elsewhere.
+class ORYX_CHRON_API FileWatcher {
+public:
+    explicit FileWatcher(std::filesystem::path path);
+    FileWatcher(const FileWatcher&) = delete;
+    auto operator=(const FileWatcher&) -> FileWatcher& = delete;
+    ~FileWatcher();
+
+    // Whether the file changed since the last call, never blocks.
+    auto HasChanged() -> bool;
+
+private:
+    auto HasChangedOnDisk() -> bool;
+
+    std::filesystem::path path_;
+    std::filesystem::file_time_type last_write_{};
+    std::uintmax_t last_size_{};
+    int inotify_{-1};
+};
+
+}  // namespace oryx::chron::details
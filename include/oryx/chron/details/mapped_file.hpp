@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include "../common.hpp"
+
+namespace oryx::chron::details {
+
+// Read only memory mapping of a whole file. Empty files map to an empty view.
+class ORYX_CHRON_API MappedFile {
+public:
+    static auto Open(const std::filesystem::path& path) -> std::optional<MappedFile>;
+
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+    ~MappedFile();
+
+    auto GetData() const -> std::string_view { return {data_, size_}; }
+
+private:
+    MappedFile() = default;
+
+    void Unmap();
+
+    const char* data_{};
+    std::size_t size_{};
+    void* mapping_{};
+};
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace oryx::chron::details {
+
+// Calls `fn(first, last)` for contiguous chunks of [0, count) on up to `num_threads` threads, the calling thread
+// being one of them. Zero threads means one per hardware thread. An exception thrown by `fn` on any thread is
+// rethrown on the calling thread once all threads are done, the first chunk's one if there are several.
+template <typename F>
+void ParallelFor(std::size_t count, std::size_t num_threads, F&& fn) {
+    // Spawning a thread is not worth it for just a few elements.
+    static constexpr std::size_t kMinChunk = 256;
+
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    num_threads = std::clamp<std::size_t>(count / kMinChunk, 1, num_threads);
+
+    // Exceptions must not leave a thread, that would terminate the process.
+    std::vector<std::exception_ptr> errors(num_threads);
+    auto run = [&fn, &errors](std::size_t i, std::size_t first, std::size_t last) {
+        try {
+            fn(first, last);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_threads - 1);
+
+        auto chunk = count / num_threads;
+        auto remainder = count % num_threads;
+        std::size_t first = 0;
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            auto last = first + chunk + (i < remainder ? 1 : 0);
+            if (i + 1 < num_threads) {
+                workers.emplace_back(run, i, first, last);
+            } else {
+                run(i, first, last);
+            }
+            first = last;
+        }
+    }
+
+    for (const auto& error : errors) {
+        if (error) [[unlikely]] {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace oryx::chron::details
@@ -2,17 +2,18 @@
 
 #include <set>
 #include <algorithm>
+#include <cstdint>
 #include <ranges>
 #include <type_traits>
 
 #include <oryx/chron/traits.hpp>
 #include <oryx/chron/chron_data.hpp>
+#include <oryx/chron/chron_masks.hpp>
 #include <oryx/chron/time_types.hpp>
 
 #include "string_cast.hpp"
 #include "in_range.hpp"
 #include "to_underlying.hpp"
-#include "any_of.hpp"
 #include "ctre.hpp"
 
 namespace oryx::chron::details {
@@ -58,14 +59,14 @@ struct Parser {
     }
 
     template <chron::traits::TimeType T>
-    static auto GetStep(std::string_view s, uint8_t& start, uint8_t& step) -> bool {
+    static auto GetStep(std::string_view s, int& start, int& step) -> bool {
         if (auto match = ctre::match<R"#((\d+|\*)/(\d+))#">(s)) {
             auto first = match.get<1>().to_view();
             int raw_start = (first == "*") ? details::to_underlying(T::First) : details::StringCast<int>(first);
             int raw_step = details::StringCast<int>(match.get<2>().to_view());
             if (IsWithinBounds<T>(raw_start, raw_start) && raw_step > 0) {
-                start = static_cast<uint8_t>(raw_start);
-                step = static_cast<uint8_t>(raw_step);
+                start = raw_start;
+                step = raw_step;
                 return true;
             }
         }
@@ -113,7 +114,7 @@ struct Parser {
     }
 
     template <chron::traits::TimeType T>
-    static auto AddStepRange(std::set<T>& numbers, uint8_t step_start, uint8_t step) -> bool {
+    static auto AddStepRange(std::set<T>& numbers, int step_start, int step) -> bool {
         bool success = true;
         const auto last_value = details::to_underlying(T::Last);
 
@@ -140,7 +141,7 @@ struct Parser {
             return AddRange(numbers, left, right);
         }
 
-        uint8_t step_start, step;
+        int step_start, step;
         if (GetStep<T>(range, step_start, step)) {
             return AddStepRange(numbers, step_start, step);
         }
@@ -148,13 +149,121 @@ struct Parser {
         return false;  // Invalid format
     }
 
+    // Jenkins style `H`, `H(a-b)`, `H/n` and `H(a-b)/n`: like a random value, except that it is derived from `key`
+    // and so stays the same for the same key. A step gets one value in each of its intervals. `H` without a range
+    // spans the field up to `last`, ranges must end there too.
     template <chron::traits::TimeType T>
-    static auto ValidateNumeric(std::string_view s, std::set<T>& numbers) -> bool {
-        return std::ranges::all_of(std::views::split(s, ','), [&numbers](auto&& part) {
-            return ConvertFromStringRangeToNumberRange(std::string_view(&*part.begin(), part.size()), numbers);
+    static auto AddHashed(std::string_view entry, uint64_t key, std::set<T>& numbers,
+                          int last = details::to_underlying(T::Last)) -> bool {
+        auto match = ctre::match<R"#(H(?:\((\d+)-(\d+)\))?(?:/(\d+))?)#">(entry);
+        if (!match) {
+            return false;
+        }
+
+        int low = details::to_underlying(T::First);
+        int high = last;
+        if (match.get<1>()) {
+            low = details::StringCast<int>(match.get<1>().to_view());
+            high = details::StringCast<int>(match.get<2>().to_view());
+            if (!IsWithinBounds<T>(low, high) || low > high || high > last) return false;
+        }
+
+        auto count = high - low + 1;
+        if (!match.get<3>()) {
+            return AddNumber(numbers, low + static_cast<int>(key % static_cast<uint64_t>(count)));
+        }
+
+        int step = details::StringCast<int>(match.get<3>().to_view());
+        if (step <= 0) {
+            return false;
+        }
+        bool success = true;
+        for (auto value = low + static_cast<int>(key % static_cast<uint64_t>(std::min(step, count))); value <= high;
+             value += step) {
+            success &= AddNumber(numbers, value);
+        }
+        return success;
+    }
+
+    template <chron::traits::TimeType T>
+    static auto ValidateNumeric(std::string_view s, std::set<T>& numbers, uint64_t key = 0) -> bool {
+        return std::ranges::all_of(std::views::split(s, ','), [&numbers, key](auto&& part) {
+            std::string_view entry(&*part.begin(), part.size());
+            if (entry.starts_with('H')) {
+                return AddHashed(entry, key, numbers);
+            }
+            return ConvertFromStringRangeToNumberRange(entry, numbers);
+        });
+    }
+
+    // Day of month field with the Quartz entries `L`, `L-n`, `LW` and `nW` next to the numeric ones. `H` stays
+    // within the first 28 days, which every month has, and `H(a-b)` past the 28th is rejected.
+    static auto ValidateMonthDays(std::string_view s, ChronData& data, uint64_t key = 0) -> bool {
+        return std::ranges::all_of(std::views::split(s, ','), [&data, key](auto&& part) {
+            std::string_view entry(&*part.begin(), part.size());
+            if (entry.starts_with('H')) {
+                return AddHashed(entry, key, data.days, 28);
+            }
+            if (entry == "L") {
+                data.last_day_offsets.emplace(0);
+                return true;
+            }
+            if (entry == "LW") {
+                data.last_weekday = true;
+                return true;
+            }
+            if (auto match = ctre::match<R"#(L-(\d+))#">(entry)) {
+                auto offset = details::StringCast<int>(match.get<1>().to_view());
+                if (!details::InRange<int>(offset, 0, 30)) return false;
+                data.last_day_offsets.emplace(static_cast<uint8_t>(offset));
+                return true;
+            }
+            if (auto match = ctre::match<R"#((\d+)W)#">(entry)) {
+                return AddNumber(data.nearest_weekdays, details::StringCast<int>(match.get<1>().to_view()));
+            }
+            return ConvertFromStringRangeToNumberRange(entry, data.days);
         });
     }
 
+    // Day of week field with the Quartz entries `dL` and `d#n` next to the numeric ones. A lone `L` is Saturday.
+    static auto ValidateWeekdays(std::string_view s, ChronData& data, uint64_t key = 0) -> bool {
+        return std::ranges::all_of(std::views::split(s, ','), [&data, key](auto&& part) {
+            std::string_view entry(&*part.begin(), part.size());
+            if (entry.starts_with('H')) {
+                return AddHashed(entry, key, data.weeks);
+            }
+            if (entry == "L") {
+                data.weeks.emplace(Weekdays::Saturday);
+                return true;
+            }
+            if (auto match = ctre::match<R"#((\d+)L)#">(entry)) {
+                return AddNumber(data.last_weekdays, details::StringCast<int>(match.get<1>().to_view()));
+            }
+            if (auto match = ctre::match<R"#((\d+)#(\d+))#">(entry)) {
+                auto weekday = details::StringCast<int>(match.get<1>().to_view());
+                auto nth = details::StringCast<int>(match.get<2>().to_view());
+                if (!IsWithinBounds<Weekdays>(weekday, weekday) || !details::InRange<int>(nth, 1, 5)) return false;
+                data.nth_weekdays.emplace(static_cast<Weekdays>(weekday), static_cast<uint8_t>(nth));
+                return true;
+            }
+            return ConvertFromStringRangeToNumberRange(entry, data.weeks);
+        });
+    }
+
+    // Optional year field, a field that allows every year is the same as none.
+    static auto ValidateYears(std::string_view s, std::set<Years>& years) -> bool {
+        if (s.empty()) {
+            return true;
+        }
+        if (!ValidateNumeric(s, years)) {
+            return false;
+        }
+        if (years.size() == details::to_underlying(Years::Last) - details::to_underlying(Years::First) + 1) {
+            years.clear();
+        }
+        return true;
+    }
+
     static auto CheckDomVsDow(std::string_view dom, std::string_view dow) -> bool {
         // Day of month and day of week are mutually exclusive so one of them must at always be ignored using
         // the '?'-character unless one field already is something other than '*'.
@@ -167,21 +276,8 @@ struct Parser {
         return (dom == "?" || dow == "?") || check(dom, dow) || check(dow, dom);
     }
 
-    static auto ValidateDateVsMonths(const ChronData& data) -> bool {
-        // Only February allowed? Ensure day_of_month includes only 1..29
-        if (data.months.size() == 1 && data.months.contains(static_cast<Months>(2))) {
-            if (!details::AnyOf(data.days, 1, 29)) return false;
-        }
-
-        // If only day 31 is selected, ensure at least one month allows it
-        if (data.days.size() == 1 && data.days.contains(MonthDays::Last)) {
-            if (!std::ranges::any_of(kMonthsWith31, [&data](Months m) { return data.months.contains(m); })) {
-                return false;
-            }
-        }
-
-        return true;
-    }
+    // Rejects schedules that never run, such as the 30th of February.
+    static auto ValidateDateVsMonths(const ChronData& data) -> bool { return ChronMasks(data).IsSatisfiable(); }
 };
 
 }  // namespace oryx::chron::details
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include <oryx/chron/common.hpp>
+
+namespace oryx::chron::details {
+
+// A different seed on every call. The system entropy source is only read once per process.
+ORYX_CHRON_API auto NextSeed() -> uint64_t;
+
+// Steps `state` and returns a well mixed word of it. Used to seed generators and to spread hashes.
+// https://prng.di.unimi.it/splitmix64.c
+constexpr auto SplitMix64(uint64_t& state) -> uint64_t {
+    auto z = (state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+// Whether `G` draws uniformly over all values of 32 or more bits. Such generators are mapped onto ranges by
+// `UniformBelow`, the same way on every platform.
+template <typename G>
+inline constexpr bool kHasWordRange = [] {
+    auto range = static_cast<uint64_t>(G::max()) - static_cast<uint64_t>(G::min());
+    return range >= 0xFFFF'FFFF && (range & (range + 1)) == 0;
+}();
+
+// Uniform in [0, bound) from the top 32 bits of a word of `generator`. `std::uniform_int_distribution` maps words
+// differently in every standard library, this gives the same values for the same words anywhere. Multiplies and
+// rejects the few products that would be biased, see https://arxiv.org/abs/1805.10941.
+template <typename G>
+    requires kHasWordRange<G>
+constexpr auto UniformBelow(G& generator, uint32_t bound) -> uint32_t {
+    constexpr auto kShift = std::bit_width(static_cast<uint64_t>(G::max()) - static_cast<uint64_t>(G::min())) - 32;
+    auto next = [&generator] {
+        return static_cast<uint32_t>((static_cast<uint64_t>(generator()) - static_cast<uint64_t>(G::min())) >> kShift);
+    };
+
+    auto product = uint64_t{next()} * bound;
+    if (static_cast<uint32_t>(product) < bound) {
+        auto threshold = static_cast<uint32_t>(0u - bound) % bound;
+        while (static_cast<uint32_t>(product) < threshold) product = uint64_t{next()} * bound;
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+// Entry `8 * byte + n` is the position of set bit number `n` of `byte`.
+inline constexpr auto kSelectInByte = [] {
+    std::array<uint8_t, 256 * 8> table{};
+    for (unsigned byte = 0; byte < 256; ++byte) {
+        for (unsigned bit = 0, rank = 0; bit < 8; ++bit) {
+            if (byte >> bit & 1u) table[byte * 8 + rank++] = static_cast<uint8_t>(bit);
+        }
+    }
+    return table;
+}();
+
+// Position of set bit number `n` of `mask`, counted from the lowest one. `mask` has to have more than `n` set bits.
+constexpr auto SelectBit(uint64_t mask, unsigned n) -> unsigned {
+#if defined(__BMI2__)
+    if !consteval {
+        return static_cast<unsigned>(std::countr_zero(_pdep_u64(uint64_t{1} << n, mask)));
+    }
+#endif
+    // Without a branch that depends on the random `n`: sums of the bits per byte find the byte the bit is in, a
+    // table the bit within that byte. https://vigna.di.unimi.it/ftp/papers/Broadword.pdf
+    constexpr uint64_t kOnes = 0x0101'0101'0101'0101;
+    constexpr uint64_t kHighs = 0x8080'8080'8080'8080;
+
+    auto sums = mask - ((mask >> 1) & 0x5555'5555'5555'5555);
+    sums = (sums & 0x3333'3333'3333'3333) + ((sums >> 2) & 0x3333'3333'3333'3333);
+    sums = ((sums + (sums >> 4)) & 0x0F0F'0F0F'0F0F'0F0F) * kOnes;
+    // Byte `i` of `sums` now counts the bits up to and including byte `i`, the bit is in the first byte above `n`.
+    auto byte = static_cast<unsigned>(std::popcount(((n * kOnes | kHighs) - sums) & kHighs));
+    auto before = static_cast<unsigned>((sums << 8) >> (8 * byte) & 0xFF);
+    return 8 * byte + kSelectInByte[(mask >> (8 * byte) & 0xFF) * 8 + n - before];
+}
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "common.hpp"
+
+namespace oryx::chron {
+
+// Append only log of the runs of all tasks, so that a restarted scheduler knows which occurrences already ran.
+// Runs are buffered and written with a single sync per `Flush`. Once the log holds far more runs than tasks, it is
+// compacted to the last run of every task on a background thread. Not thread safe on its own, the scheduler only
+// uses it under its lock.
+class ORYX_CHRON_API Journal {
+public:
+    static constexpr uint32_t kVersion = 1;
+    // Compaction starts once the log holds at least this many runs and more than twice as many as tasks.
+    static constexpr std::size_t kMinCompactionSize = 1 << 16;
+
+    struct Run {
+        // The occurrence that ran.
+        TimePoint scheduled;
+        TimePoint fired;
+    };
+
+    // Opens or creates the journal at `path` and replays it. A run that was only partly written is dropped, files
+    // that are not a journal are left alone.
+    static auto Open(const std::filesystem::path& path) -> std::unique_ptr<Journal>;
+
+    Journal(const Journal&) = delete;
+    auto operator=(const Journal&) -> Journal& = delete;
+    // Writes everything still buffered and waits for a running compaction.
+    ~Journal();
+
+    void Append(std::string_view name, TimePoint scheduled, TimePoint fired);
+
+    // Writes and syncs the runs appended since the last call.
+    auto Flush() -> bool;
+
+    auto GetLastRun(std::string_view name) const -> std::optional<Run>;
+    auto GetNumTasks() const -> std::size_t { return last_runs_.size(); }
+
+private:
+    struct Record {
+        uint64_t task;
+        int64_t scheduled;
+        int64_t fired;
+    };
+
+    Journal(std::filesystem::path path, int file, std::size_t num_records);
+
+    static auto TaskId(std::string_view name) -> uint64_t;
+
+    void StartCompaction();
+    void FinishCompaction();
+
+    std::filesystem::path path_;
+    int file_;
+    // Runs in the file, superseded ones included.
+    std::size_t num_records_;
+    std::vector<Record> buffer_;
+    std::unordered_map<uint64_t, Record> last_runs_;
+
+    std::future<bool> compaction_;
+    std::size_t num_compacted_{};
+    // Runs written while the compaction was busy, they are added to the compacted file before it is swapped in.
+    std::vector<Record> compacted_later_;
+};
+
+}  // namespace oryx::chron
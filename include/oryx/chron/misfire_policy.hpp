@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "common.hpp"
+
+namespace oryx::chron {
+
+enum class MisfireAction : uint8_t {
+    // Overdue tasks run once, but after the clock jumped forward by 3 hours or more every task is rescheduled from
+    // the current time and the missed occurrences are dropped.
+    Reschedule,
+    // Overdue tasks run once, no matter how long the gap was.
+    FireOnce,
+    // Every missed occurrence runs in order, at most `max_runs` times per tick. Further ones are dropped.
+    FireAll,
+    // Occurrences overdue by `tolerance` or more are dropped and the task is rescheduled from the current time.
+    Skip,
+};
+
+// What happens to the occurrences of a task that passed without a tick.
+struct MisfirePolicy {
+    MisfireAction action{MisfireAction::Reschedule};
+    std::size_t max_runs{1000};
+    Duration tolerance{std::chrono::seconds{1}};
+};
+
+}  // namespace oryx::chron
@@ -1,60 +1,174 @@
 #pragma once
 
+#include <cstdint>
 #include <mutex>
+#include <string>
 #include <string_view>
 #include <optional>
+#include <ranges>
 #include <functional>
 #include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "common.hpp"
 #include "chron_data.hpp"
 #include "traits.hpp"
 #include "null_mutex.hpp"
+#include "details/random.hpp"
 
 namespace oryx::chron {
 
+// Key that `H` fields of the task `name` are derived from. It only depends on the bytes of `name` and on `seed`, so
+// every process and every platform computes the same one.
+ORYX_CHRON_API auto MakeHashKey(std::string_view name, uint64_t seed = 0) -> uint64_t;
+
 struct ORYX_CHRON_API ExpressionParser {
-    auto operator()(std::string_view cron_expression) const -> std::optional<ChronData>;
+    // `H` fields get values derived from `hash_key`, see `MakeHashKey`.
+    auto operator()(std::string_view cron_expression, uint64_t hash_key = 0) const -> std::optional<ChronData>;
 };
 
+// Remembers the schedule of every expression it parsed. Schedules are interned by content, so expressions that are
+// written differently but mean the same share a single copy. Expressions that only differ in blanks are recognized
+// without parsing them again.
 template <traits::BasicLockable MutexType = NullMutex>
 class CachedExpressionParser : ExpressionParser {
 public:
-    using Pair = std::pair<std::size_t, ChronData>;
+    auto operator()(std::string_view cron_expression, uint64_t hash_key = 0) const -> std::optional<ChronData> {
+        // The same expression with `H` fields means something else for every hash key, caching those would keep an
+        // entry per task.
+        if (hash_key != 0 && HasHashedFields(cron_expression)) [[unlikely]] {
+            return ExpressionParser::operator()(cron_expression, hash_key);
+        }
 
-    auto operator()(std::string_view cron_expression) const -> std::optional<ChronData> {
         std::lock_guard lock{mtx_};
-        auto it = std::ranges::find(cache_, hash_(cron_expression), &Pair::first);
-        if (it != cache_.end()) {
-            return it->second;
+        if (auto it = expressions_.find(cron_expression); it != expressions_.end()) {
+            return *it->second;
         }
 
         auto data = ExpressionParser::operator()(cron_expression);
-        if (data) cache_.emplace_back(hash_(cron_expression), data.value());
+        if (data) {
+            auto schedule = schedules_.insert(std::move(data.value())).first;
+            expressions_.emplace(NormalizeBlanks(cron_expression), &*schedule);
+            return *schedule;
+        }
         return data;
     }
 
     void Clear() {
         std::lock_guard lock{mtx_};
-        cache_.clear();
+        expressions_.clear();
+        schedules_.clear();
     }
 
     auto Contains(std::string_view cron_expression) const -> bool {
         std::lock_guard lock{mtx_};
-        return std::ranges::find(cache_, hash_(cron_expression), &Pair::first) != cache_.end();
+        return expressions_.contains(cron_expression);
     }
 
+    // Number of cached expressions, spellings that only differ in blanks count once.
     auto GetSize() const -> size_t {
         std::lock_guard lock{mtx_};
-        return cache_.size();
+        return expressions_.size();
+    }
+
+    // Number of distinct schedules among the cached expressions.
+    auto GetNumSchedules() const -> size_t {
+        std::lock_guard lock{mtx_};
+        return schedules_.size();
     }
 
 private:
-    std::hash<std::string_view> hash_{};
+    static constexpr std::string_view kBlanks = " \t\r\n";
+
+    // Calls `fn` with every field of `cron_expression`, however many blanks separate them.
+    template <typename F>
+    static void ForEachField(std::string_view cron_expression, F&& fn) {
+        for (auto first = cron_expression.find_first_not_of(kBlanks); first != std::string_view::npos;) {
+            auto last = std::min(cron_expression.find_first_of(kBlanks, first), cron_expression.size());
+            fn(cron_expression.substr(first, last - first));
+            first = cron_expression.find_first_not_of(kBlanks, last);
+        }
+    }
+
+    // Whether an entry of any field is `H`, `H(a-b)` or `H/n`. Names such as `THU` or `MARCH` contain an `H`
+    // without being hashed.
+    static auto HasHashedFields(std::string_view cron_expression) -> bool {
+        bool hashed{};
+        ForEachField(cron_expression, [&hashed](std::string_view field) {
+            for (auto entry : std::views::split(field, ',')) {
+                hashed |= !entry.empty() && *entry.begin() == 'H';
+            }
+        });
+        return hashed;
+    }
+
+    static auto NormalizeBlanks(std::string_view cron_expression) -> std::string {
+        std::string normalized;
+        normalized.reserve(cron_expression.size());
+        ForEachField(cron_expression, [&normalized](std::string_view field) {
+            if (!normalized.empty()) normalized += ' ';
+            normalized += field;
+        });
+        return normalized;
+    }
+
+    // Hash and equality of expressions that ignore how many blanks separate the fields, so that lookups neither
+    // normalize nor allocate. Equal texts are compared on every hit, hashes only pick the bucket.
+    struct ExpressionHash {
+        using is_transparent = void;
+
+        auto operator()(std::string_view cron_expression) const -> std::size_t {
+            std::size_t hash{};
+            ForEachField(cron_expression, [&hash](std::string_view field) {
+                hash = (hash ^ std::hash<std::string_view>{}(field)) * 0x100000001b3;
+            });
+            return hash;
+        }
+    };
+
+    struct ExpressionEqual {
+        using is_transparent = void;
+
+        auto operator()(std::string_view lhs, std::string_view rhs) const -> bool {
+            auto next = [](std::string_view& expression) {
+                auto first = std::min(expression.find_first_not_of(kBlanks), expression.size());
+                auto last = std::min(expression.find_first_of(kBlanks, first), expression.size());
+                auto field = expression.substr(first, last - first);
+                expression.remove_prefix(last);
+                return field;
+            };
+            while (true) {
+                auto left = next(lhs);
+                auto right = next(rhs);
+                if (left != right) return false;
+                if (left.empty()) return true;
+            }
+        }
+    };
+
     mutable MutexType mtx_{};
-    mutable std::vector<Pair> cache_{};
+    mutable std::unordered_set<ChronData> schedules_{};
+    // Nodes of `schedules_` never move, so expressions can point straight at them.
+    mutable std::unordered_map<std::string, const ChronData*, ExpressionHash, ExpressionEqual> expressions_{};
 };
 
 inline constexpr ExpressionParser kParseExpression{};
 
+namespace traits {
+
+// Parsers that may be called from several threads at once.
+template <typename T>
+struct IsConcurrentParser : std::false_type {};
+
+template <>
+struct IsConcurrentParser<ExpressionParser> : std::true_type {};
+
+template <typename MutexType>
+struct IsConcurrentParser<CachedExpressionParser<MutexType>>
+    : std::bool_constant<!std::is_same_v<MutexType, NullMutex>> {};
+
+}  // namespace traits
+
 }  // namespace oryx::chron
\ No newline at end of file
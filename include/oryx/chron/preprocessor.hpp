@@ -1,41 +1,129 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
 #include "traits.hpp"
 
 namespace oryx::chron {
 
-template <traits::Processor... Ps>
-struct Processors;
+// Output of a single processor. Expressions of up to `kInlineSize` characters stay on the stack, longer ones move
+// to the heap.
+class ExpressionBuffer {
+public:
+    static constexpr std::size_t kInlineSize = 128;
+
+    ExpressionBuffer() = default;
+    ExpressionBuffer(const ExpressionBuffer&) = delete;
+    auto operator=(const ExpressionBuffer&) -> ExpressionBuffer& = delete;
+
+    void Clear() {
+        size_ = 0;
+        heap_.clear();
+    }
+
+    void Append(char c) { Append(std::string_view(&c, 1)); }
+
+    void Append(std::string_view text) {
+        if (size_ + text.size() <= kInlineSize) [[likely]] {
+            std::memcpy(inline_.data() + size_, text.data(), text.size());
+        } else {
+            if (heap_.empty()) heap_.assign(inline_.data(), size_);
+            heap_.append(text);
+        }
+        size_ += text.size();
+    }
+
+    auto View() const -> std::string_view {
+        return size_ <= kInlineSize ? std::string_view(inline_.data(), size_) : std::string_view(heap_);
+    }
 
-template <>
-struct Processors<> {
-    static void Process(std::string&) noexcept {}
+private:
+    std::array<char, kInlineSize> inline_;
+    std::string heap_;
+    std::size_t size_{};
 };
 
-template <traits::Processor Curr, traits::Processor... Rest>
-struct Processors<Curr, Rest...> {
-    static auto Process(std::string data) noexcept -> std::string {
-        if constexpr (sizeof...(Rest) == 0)
-            return Curr::Process(std::move(data));
-        else
-            return Processors<Rest...>::Process(Curr::Process(std::move(data)));
+// Runs the processors in order. One scan over a compile time table of all their trigger characters decides which
+// of them have anything to do, so expressions without any triggers are passed on without being copied.
+template <traits::Processor... Ps>
+class Preprocessor {
+public:
+    static_assert(sizeof...(Ps) <= 8, "trigger table has room for 8 processors");
+
+    // The result stays valid until the next call, it is `expression` itself when no processor applies.
+    auto Process(std::string_view expression) noexcept -> std::string_view {
+        auto triggered = Scan(expression);
+        if (triggered == 0) [[likely]] {
+            return expression;
+        }
+        current_ = -1;
+        return Run<0, Ps...>(expression, triggered);
     }
+
+private:
+    static constexpr auto kTriggers = [] {
+        std::array<uint8_t, 256> table{};
+        uint8_t bit = 1;
+        ((std::ranges::for_each(std::string_view(Ps::kTriggers),
+                                [&](char c) { table[static_cast<unsigned char>(c)] |= bit; }),
+          bit = static_cast<uint8_t>(bit << 1)),
+         ...);
+        return table;
+    }();
+
+    static auto Scan(std::string_view expression) -> uint8_t {
+        uint8_t triggered{};
+        for (auto c : expression) triggered |= kTriggers[static_cast<unsigned char>(c)];
+        return triggered;
+    }
+
+    template <std::size_t I, typename P, typename... Rest>
+    auto Run(std::string_view expression, uint8_t triggered) noexcept -> std::string_view {
+        if (triggered >> I & 1u) {
+            // Writes go to the buffer that does not hold the input.
+            current_ = current_ == 0 ? 1 : 0;
+            auto& out = buffers_[static_cast<std::size_t>(current_)];
+            out.Clear();
+            P::Process(expression, out);
+            expression = out.View();
+            if constexpr (sizeof...(Rest) > 0) triggered = Scan(expression);
+        }
+        if constexpr (sizeof...(Rest) > 0) {
+            return Run<I + 1, Rest...>(expression, triggered);
+        } else {
+            return expression;
+        }
+    }
+
+    std::array<ExpressionBuffer, 2> buffers_;
+    int current_{-1};
 };
 
+// Replaces a whole `@yearly`, `@daily`, ... expression with the one it stands for.
 struct ORYX_CHRON_API DollarExpressionProcessor {
-    static auto Process(std::string data) noexcept -> std::string;
+    static constexpr std::string_view kTriggers = "@";
+    static void Process(std::string_view expression, ExpressionBuffer& out) noexcept;
 };
 
+// Replaces the names of months and weekdays (case insensitive) in their fields with numbers.
 struct ORYX_CHRON_API WeekMonthDayLiteralProcessor {
-    static auto Process(std::string data) noexcept -> std::string;
+    static constexpr std::string_view kTriggers = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    static void Process(std::string_view expression, ExpressionBuffer& out) noexcept;
 };
 
 template <traits::Processor... Ps>
-auto PreprocessExpression(std::string data) noexcept -> std::string {
-    return Processors<Ps...>::Process(data);
+auto PreprocessExpression(std::string_view expression) -> std::string {
+    Preprocessor<Ps...> preprocessor;
+    return std::string(preprocessor.Process(expression));
 }
 
 static_assert(traits::Processor<DollarExpressionProcessor>);
 static_assert(traits::Processor<WeekMonthDayLiteralProcessor>);
 
-}  // namespace oryx::chron
\ No newline at end of file
+}  // namespace oryx::chron
@@ -1,25 +1,237 @@
 #pragma once
 
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <optional>
 #include <random>
 
 #include "common.hpp"
+#include "chron_masks.hpp"
+#include "traits.hpp"
+#include "details/random.hpp"
 
 namespace oryx::chron {
 
-class ORYX_CHRON_API Randomization {
+// Expression with `R(a-b)` fields, parsed once so that any number of schedules can be drawn from it without going
+// through the expression text again.
+class ORYX_CHRON_API RandomizationTemplate {
 public:
-    Randomization();
+    // Fields in the order of the expression.
+    enum class Field : uint8_t { Seconds, Minutes, Hours, MonthDays, Months, Weekdays };
 
-    Randomization(const Randomization&) = delete;
-    auto operator=(const Randomization&) -> Randomization& = delete;
+    // Spans of the calendar, see `GetPeriod`.
+    enum class Period : uint8_t { Minute, Hour, Day, Week, Month, Year };
 
-    auto Parse(std::string_view cron_schedule) -> std::optional<std::string>;
+    // Fails for invalid fixed fields and for random ranges without any valid value.
+    static auto Parse(std::string_view cron_schedule) -> std::optional<RandomizationTemplate>;
+
+    auto IsRandom(Field field) const -> bool { return (random_fields_ >> static_cast<unsigned>(field) & 1u) != 0; }
+
+    auto HasRandomFields() const -> bool { return random_fields_ != 0; }
+
+    // Masks of the fixed fields, random fields hold all of their candidates.
+    auto GetMasks() const -> const ChronMasks& { return masks_; }
+
+    // Shortest span that contains every choice of the random fields: a minute for a random second, an hour for a
+    // random minute, a day for a random hour, a week for a random weekday, a month for a random day of month and a
+    // year for a random month.
+    auto GetPeriod() const -> Period {
+        if (IsRandom(Field::Months)) return Period::Year;
+        if (IsRandom(Field::MonthDays)) return Period::Month;
+        if (IsRandom(Field::Weekdays)) return Period::Week;
+        if (IsRandom(Field::Hours)) return Period::Day;
+        if (IsRandom(Field::Minutes)) return Period::Hour;
+        return Period::Minute;
+    }
+
+private:
+    template <traits::RandomGenerator>
+    friend class BasicRandomization;
+
+    RandomizationTemplate() = default;
+
+    // Candidates of a random day of month that exist in the shortest of `months`.
+    auto GetDayCandidates(uint16_t months) const -> uint32_t {
+        if (months & ChronMasks::kFebruary) return day_candidates_[0];
+        if (months & ChronMasks::kMonthsWith30) return day_candidates_[1];
+        return day_candidates_[2];
+    }
+
+    ChronMasks masks_;
+    uint8_t random_fields_{};
+    // Candidates of a random day of month for months of up to 29, 30 and 31 days.
+    std::array<uint32_t, 3> day_candidates_{};
+};
+
+// How many schedules use each second, minute and hour. Random fields placed through it go where the fewest other
+// schedules run. Not thread safe.
+class ORYX_CHRON_API Occupancy {
+public:
+    void Add(const ChronMasks& masks) { Update(masks, 1); }
+    // `masks` has to be added before.
+    void Remove(const ChronMasks& masks) { Update(masks, -1); }
+
+    auto GetSeconds() const -> const std::array<uint32_t, 60>& { return seconds_; }
+    auto GetMinutes() const -> const std::array<uint32_t, 60>& { return minutes_; }
+    auto GetHours() const -> const std::array<uint32_t, 24>& { return hours_; }
+
+private:
+    template <traits::RandomGenerator>
+    friend class BasicRandomization;
+
+    void Update(const ChronMasks& masks, int delta);
+
+    // The ones among `candidates` that are used the least.
+    template <std::size_t N>
+    static auto GetLeastUsed(uint64_t candidates, const std::array<uint32_t, N>& counts) -> uint64_t {
+        uint64_t least{};
+        auto min = ~uint32_t{0};
+        for (; candidates != 0; candidates &= candidates - 1) {
+            auto bit = static_cast<unsigned>(std::countr_zero(candidates));
+            if (counts[bit] < min) {
+                min = counts[bit];
+                least = 0;
+            }
+            if (counts[bit] == min) least |= uint64_t{1} << bit;
+        }
+        return least;
+    }
+
+    std::array<uint32_t, 60> seconds_{};
+    std::array<uint32_t, 60> minutes_{};
+    std::array<uint32_t, 24> hours_{};
+};
+
+// xoshiro256++, small and fast enough to be kept per thread or per task. Seeds go through SplitMix64 first, so every
+// seed, zero included, gives a usable state. https://prng.di.unimi.it/xoshiro256plusplus.c
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    constexpr explicit Xoshiro256(uint64_t seed) {
+        for (auto& word : state_) word = details::SplitMix64(seed);
+    }
+
+    static constexpr auto min() -> result_type { return 0; }
+    static constexpr auto max() -> result_type { return ~result_type{0}; }
+
+    constexpr auto operator()() -> result_type {
+        auto result = std::rotl(state_[0] + state_[3], 23) + state_[0];
+        auto t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
 
 private:
-    std::random_device random_device_;
-    std::mt19937 twister_;
+    std::array<uint64_t, 4> state_{};
 };
 
+// Resolves `R(a-b)` fields with random values from `Generator`. Instances are cheap to create and copy but not
+// thread safe, `ForThisThread` hands out one per thread.
+template <traits::RandomGenerator Generator = Xoshiro256>
+class BasicRandomization {
+public:
+    // Every instance gets a different seed.
+    BasicRandomization()
+        : BasicRandomization(details::NextSeed()) {}
+
+    // Instances with the same seed draw the same schedules, in the same order.
+    explicit BasicRandomization(uint64_t seed)
+        : generator_(seed) {}
+
+    static auto ForThisThread() -> BasicRandomization& {
+        thread_local BasicRandomization randomization;
+        return randomization;
+    }
+
+    // Resolves the `R(a-b)` fields of `cron_schedule` into a plain expression.
+    auto Parse(std::string_view cron_schedule) -> std::optional<std::string> {
+        auto pattern = RandomizationTemplate::Parse(cron_schedule);
+        if (!pattern) [[unlikely]] {
+            return std::nullopt;
+        }
+
+        auto masks = Generate(*pattern);
+        if (!masks) [[unlikely]] {
+            return std::nullopt;
+        }
+        return masks->ToCanonicalString();
+    }
+
+    // Picks one candidate for each random field of `pattern`. Nothing when the picked days of month do not exist in
+    // any of the months, such as `31 R(1-12)` drawing April.
+    auto Generate(const RandomizationTemplate& pattern) -> std::optional<ChronMasks> { return Draw(pattern, nullptr); }
+
+    // Same as `Generate`, except that random seconds, minutes and hours go to the candidates the fewest schedules of
+    // `occupancy` use, picking randomly among equally used ones. The result is added to `occupancy`.
+    auto Place(const RandomizationTemplate& pattern, Occupancy& occupancy) -> std::optional<ChronMasks> {
+        auto masks = Draw(pattern, &occupancy);
+        if (masks) occupancy.Add(*masks);
+        return masks;
+    }
+
+    auto GetGenerator() -> Generator& { return generator_; }
+
+private:
+    auto Draw(const RandomizationTemplate& pattern, const Occupancy* occupancy) -> std::optional<ChronMasks> {
+        using Field = RandomizationTemplate::Field;
+
+        auto masks = pattern.masks_;
+        if (occupancy) {
+            // Only the least used candidates are left to pick from.
+            if (pattern.IsRandom(Field::Seconds)) {
+                masks.seconds = Occupancy::GetLeastUsed(masks.seconds, occupancy->seconds_);
+            }
+            if (pattern.IsRandom(Field::Minutes)) {
+                masks.minutes = Occupancy::GetLeastUsed(masks.minutes, occupancy->minutes_);
+            }
+            if (pattern.IsRandom(Field::Hours)) {
+                masks.hours = static_cast<uint32_t>(Occupancy::GetLeastUsed(masks.hours, occupancy->hours_));
+            }
+        }
+        if (pattern.IsRandom(Field::Seconds)) masks.seconds = PickOne(masks.seconds);
+        if (pattern.IsRandom(Field::Minutes)) masks.minutes = PickOne(masks.minutes);
+        if (pattern.IsRandom(Field::Hours)) masks.hours = PickOne(masks.hours);
+        // Months come first, they decide how far a random day of month may go.
+        if (pattern.IsRandom(Field::Months)) masks.months = PickOne(masks.months);
+        if (pattern.IsRandom(Field::MonthDays)) masks.days = PickOne(pattern.GetDayCandidates(masks.months));
+        if (pattern.IsRandom(Field::Weekdays)) masks.weeks = PickOne(masks.weeks);
+
+        if (!masks.IsSatisfiable()) [[unlikely]] {
+            return std::nullopt;
+        }
+        return masks;
+    }
+
+    // One of the set bits of `candidates`, each with the same chance. Generators with a range of whole words pick
+    // the same bits on every platform, others go through `std::uniform_int_distribution`.
+    template <std::unsigned_integral Mask>
+    auto PickOne(Mask candidates) -> Mask {
+        auto count = static_cast<uint32_t>(std::popcount(candidates));
+        unsigned rank{};
+        if constexpr (details::kHasWordRange<Generator>) {
+            rank = details::UniformBelow(generator_, count);
+        } else {
+            rank = std::uniform_int_distribution<unsigned>(0, count - 1)(generator_);
+        }
+        return static_cast<Mask>(Mask{1} << details::SelectBit(candidates, rank));
+    }
+
+    Generator generator_;
+};
+
+// Instantiated once in the library.
+extern template class ORYX_CHRON_API BasicRandomization<Xoshiro256>;
+
+using Randomization = BasicRandomization<>;
+
 }  // namespace oryx::chron
@@ -1,24 +1,182 @@
 #pragma once
 
+#include <cstddef>
+#include <iterator>
 #include <optional>
+#include <span>
+#include <utility>
 
 #include "common.hpp"
 #include "chron_data.hpp"
+#include "chron_masks.hpp"
 #include "date_time.hpp"
+#include "details/civil.hpp"
 
 namespace oryx::chron {
 
 class ORYX_CHRON_API Schedule {
 public:
-    explicit Schedule(ChronData data)
-        : data_(std::move(data)) {}
+    // Calendar position of a search. Keeping it around avoids decomposing time points over and over again.
+    struct Cursor {
+        explicit Cursor(TimePoint time)
+            : date(std::chrono::floor<std::chrono::days>(time).time_since_epoch().count()) {
+            auto time_of_day = std::chrono::floor<std::chrono::seconds>(time) -
+                               std::chrono::floor<std::chrono::days>(time);
+            auto total = static_cast<unsigned>(time_of_day.count());
+            hour = static_cast<uint8_t>(total / 3600);
+            minute = static_cast<uint8_t>(total / 60 % 60);
+            second = static_cast<uint8_t>(total % 60);
+        }
+
+        auto ToTimePoint() const -> TimePoint {
+            return std::chrono::sys_days(std::chrono::days(date.GetDays())) + std::chrono::hours(hour) +
+                   std::chrono::minutes(minute) + std::chrono::seconds(second);
+        }
+
+        details::DayCursor date;
+        uint8_t hour;
+        uint8_t minute;
+        uint8_t second;
+    };
+
+    // Shortest and longest time between two consecutive occurrences.
+    struct Gaps {
+        std::chrono::seconds min;
+        std::chrono::seconds max;
+    };
+
+    // Shapes of schedules whose next occurrence is computed directly, all others go through the general search.
+    enum class Kind : uint8_t {
+        General,
+        // Evenly spaced times of day on every day, such as `*/15 * * * * ?`, `0 */5 * * * ?` or `0 30 2 * * ?`.
+        Interval,
+        // Any times of day on every day.
+        Daily,
+        // Any times of day on some days of the week.
+        Weekly,
+    };
+
+    class OccurrenceRange;
+
+    explicit Schedule(const ChronData& data)
+        : Schedule(ChronMasks(data)) {}
+
+    explicit Schedule(ChronMasks masks)
+        : masks_(masks) {
+        Classify();
+    }
 
     auto CalculateFrom(const TimePoint& from) const -> std::optional<TimePoint>;
 
+    // Latest occurrence at or before `at`.
+    auto CalculatePrevious(const TimePoint& at) const -> std::optional<TimePoint>;
+
+    // Fills `out` with consecutive occurrences at or after `from`, returns how many were found. Less than
+    // `out.size()` are only returned when the schedule runs out of occurrences.
+    auto NextN(const TimePoint& from, std::span<TimePoint> out) const -> std::size_t;
+
+    // Lazily walks through the occurrences in [from, until).
+    auto Occurrences(const TimePoint& from, const TimePoint& until) const -> OccurrenceRange;
+
+    // Moves the cursor to the first occurrence at or after its current position. Fields past their last value
+    // (e.g. second 60) carry over into the next higher field.
+    auto Advance(Cursor& cursor) const -> bool;
+
+    // Moves the cursor to the last occurrence at or before its current position.
+    auto Retreat(Cursor& cursor) const -> bool;
+
+    // Exact over the whole 400 year Gregorian cycle, after which the calendar repeats itself including weekdays, or
+    // over the years of the year field. Nothing for schedules that run less than twice.
+    auto GetGaps() const -> std::optional<Gaps>;
+
+    auto GetMasks() const -> const ChronMasks& { return masks_; }
+    auto GetKind() const -> Kind { return kind_; }
+
     static auto ToCalendarTime(TimePoint time) -> DateTime;
 
 private:
-    ChronData data_;
+    void Classify();
+
+    static constexpr unsigned kReciprocalShift = 40;
+
+    // Moves to the first time of day at or after the given one, false if there is none left on that day.
+    auto NextTimeOfDay(unsigned& hour, unsigned& minute, unsigned& second) const -> bool;
+
+    // Whether a schedule of any kind but `General` runs on the given day of week.
+    auto RunsOn(unsigned weekday) const -> bool;
+    auto DaysToNextRun(unsigned weekday) const -> unsigned;
+
+    // Days ahead and time of day of the next occurrence for all kinds but `General`. `time` may run past the end of
+    // the day by a second.
+    auto NextInDays(unsigned time, unsigned weekday) const -> std::pair<unsigned, unsigned>;
+
+    ChronMasks masks_;
+    Kind kind_{Kind::General};
+    // Seconds between occurrences of an `Interval` schedule and the multiplier that divides by it.
+    uint32_t period_{};
+    uint64_t period_reciprocal_{};
+    // Earliest time of day in seconds.
+    uint32_t first_time_{};
 };
 
+class Schedule::OccurrenceRange {
+public:
+    class Iterator {
+    public:
+        using value_type = TimePoint;
+        using difference_type = std::ptrdiff_t;
+
+        auto operator*() const -> const TimePoint& { return current_; }
+
+        auto operator++() -> Iterator& {
+            cursor_.second++;
+            Next();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend auto operator==(const Iterator& it, std::default_sentinel_t) -> bool { return it.done_; }
+
+    private:
+        friend class OccurrenceRange;
+
+        explicit Iterator(const OccurrenceRange& occurrences)
+            : occurrences_(&occurrences),
+              cursor_(occurrences.from_) {
+            Next();
+        }
+
+        void Next() {
+            done_ = !occurrences_->schedule_.Advance(cursor_);
+            if (!done_) {
+                current_ = cursor_.ToTimePoint();
+                done_ = current_ >= occurrences_->until_;
+            }
+        }
+
+        const OccurrenceRange* occurrences_;
+        Cursor cursor_;
+        TimePoint current_{};
+        bool done_{};
+    };
+
+    OccurrenceRange(Schedule schedule, TimePoint from, TimePoint until)
+        : schedule_(schedule),
+          from_(from),
+          until_(until) {}
+
+    auto begin() const -> Iterator { return Iterator(*this); }
+    auto end() const -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+    Schedule schedule_;
+    TimePoint from_;
+    TimePoint until_;
+};
+
+inline auto Schedule::Occurrences(const TimePoint& from, const TimePoint& until) const -> OccurrenceRange {
+    return {*this, from, until};
+}
+
 }  // namespace oryx::chron
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "chron_masks.hpp"
+#include "schedule.hpp"
+
+namespace oryx::chron {
+
+// Answers which of many schedules fire at a given second. The field masks are kept in structure of arrays form so
+// that a single decomposed time point is tested against several schedules per instruction.
+class ORYX_CHRON_API ScheduleMatcher {
+public:
+    void Reserve(std::size_t count);
+
+    // Returns the index the schedule is reported with.
+    auto Add(const ChronMasks& masks) -> std::size_t;
+    auto Add(const Schedule& schedule) -> std::size_t { return Add(schedule.GetMasks()); }
+
+    void Clear();
+
+    auto GetSize() const -> std::size_t { return seconds_.size(); }
+
+    // Bit `i % 64` of word `i / 64` is set when schedule `i` fires at `time`.
+    void Match(TimePoint time, std::vector<uint64_t>& bitmap) const;
+
+    // Indices of the schedules firing at `time` in ascending order.
+    void MatchIndices(TimePoint time, std::vector<std::size_t>& indices) const;
+
+private:
+    // Hours and months as well as month days and weekdays share a column, each column matches when all bits of
+    // the probe built from the time point are set.
+    std::vector<uint64_t> seconds_;
+    std::vector<uint64_t> minutes_;
+    std::vector<uint64_t> hours_months_;
+    std::vector<uint64_t> days_weeks_;
+    // Schedules with Quartz style days or a year field, their days are worked out per month after the columns.
+    std::vector<std::pair<std::size_t, ChronMasks>> calendar_;
+};
+
+}  // namespace oryx::chron
@@ -2,17 +2,27 @@
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_set>
 #include <vector>
 
 #include "common.hpp"
+#include "details/parallel_for.hpp"
 #include "traits.hpp"
 #include "clock.hpp"
+#include "crontab.hpp"
+#include "journal.hpp"
+#include "misfire_policy.hpp"
 #include "parser.hpp"
+#include "snapshot.hpp"
 #include "task.hpp"
+#include "time_zone.hpp"
 
 namespace oryx::chron {
 
@@ -21,6 +31,8 @@ template <traits::Clock ClockType = LocalClock,
           traits::Parser ParserType = ExpressionParser>
 class Scheduler {
 public:
+    static constexpr std::size_t kDefaultRecalculationBudget = 1 << 16;
+
     Scheduler() = default;
 
     auto AddSchedule(std::string name, std::string_view cron_expr, TaskFn work) -> bool {
@@ -30,7 +42,68 @@ public:
         }
 
         std::lock_guard lock{tasks_mtx_};
-        tasks_.emplace_back(std::move(task.value()));
+        if (UnsafeIsNameTaken(task->GetName())) [[unlikely]] {
+            return false;
+        }
+        UnsafeOccupy(tasks_.emplace_back(std::move(task.value())));
+        UnsafeSortTasks();
+        return true;
+    }
+
+    // Adds a task whose expression is evaluated on the wall clock of `time_zone`. All tasks share a single queue
+    // on the timeline of the scheduler clock, so one scheduler can serve any number of time zones.
+    auto AddSchedule(std::string name, std::string_view cron_expr, std::string_view time_zone, TaskFn work) -> bool {
+        std::lock_guard lock{tasks_mtx_};
+        if (UnsafeIsNameTaken(name)) [[unlikely]] {
+            return false;
+        }
+        auto zone = UnsafeGetTimeZone(time_zone);
+        if (!zone) [[unlikely]] {
+            return false;
+        }
+
+        auto task = MakeTask(std::move(name), cron_expr, std::move(work), std::move(zone));
+        if (!task) [[unlikely]] {
+            return false;
+        }
+
+        UnsafeOccupy(tasks_.emplace_back(std::move(task.value())));
+        UnsafeSortTasks();
+        return true;
+    }
+
+    // Adds a task for an expression with `R(a-b)` fields, see `Randomization`. Unlike schedules resolved once by
+    // `Randomization::Parse`, the fields are drawn again for every period of the expression, e.g. each day for a
+    // random hour. The template is parsed once here, redraws neither parse nor allocate. The draw of each period is
+    // seeded from the name of the task, the hash seed, see `SetHashSeed`, and the period, so every node that uses the
+    // same seed draws alike for every period, whenever it started.
+    auto AddRandomizedSchedule(std::string name, std::string_view rand_expr, TaskFn work) -> bool {
+        auto pattern = RandomizationTemplate::Parse(rand_expr);
+        if (!pattern) [[unlikely]] {
+            return false;
+        }
+
+        auto shared = std::make_shared<const RandomizationTemplate>(std::move(pattern.value()));
+        auto key = MakeHashKey(name, hash_seed_);
+        Task task(std::move(name), Schedule(shared->GetMasks()), std::move(work), nullptr, std::string(rand_expr));
+        Disperse(task);
+
+        // Draws are placed on the occupancy as it is when the task joins the queue.
+        std::lock_guard lock{tasks_mtx_};
+        if (UnsafeIsNameTaken(task.GetName())) [[unlikely]] {
+            return false;
+        }
+        if (!shared->HasRandomFields()) {
+            UnsafeOccupy(task);
+        } else if (!task.SetRandomization(std::move(shared), key, occupancy_.get())) [[unlikely]] {
+            return false;
+        }
+        if (!task.CalculateNext(clock_.Now())) [[unlikely]] {
+            UnsafeVacate(task);
+            return false;
+        }
+
+        tasks_.emplace_back(std::move(task));
         UnsafeSortTasks();
         return true;
     }
@@ -54,30 +127,348 @@ public:
         }
 
         std::lock_guard lock{tasks_mtx_};
+        UnsafeDropTakenNames(tasks);
+        for (const auto& task : tasks) UnsafeOccupy(task);
         tasks_.reserve(tasks_.size() + tasks.size());
         tasks_.insert(tasks_.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
         UnsafeSortTasks();
         return true;
     }
 
+    // Adds a task for each entry of `crontab`, all of them running `work`. Tasks are sorted into the queue in a
+    // single step, entries that can not be scheduled are reported and skipped.
+    auto AddCrontab(const Crontab& crontab, TaskFn work) -> std::vector<CrontabError> {
+        std::vector<CrontabError> errors;
+        AddScheduleBatch([&crontab, &work, &errors](auto add_schedule) {
+            crontab.ForEach([&](const Crontab::Entry& entry) {
+                if (entry.expression.empty()) [[unlikely]] {
+                    errors.emplace_back(entry.line, entry.offset, "missing expression");
+                } else if (!add_schedule(std::string(entry.name), entry.expression, work)) [[unlikely]] {
+                    errors.emplace_back(entry.line, entry.offset,
+                                        "invalid expression '" + std::string(entry.expression) + "'");
+                }
+            });
+        });
+        return errors;
+    }
+
+    // Same as `AddScheduleBatch`, except that `add_schedule` only collects the schedules. Parsing and calculating
+    // the first run happens afterwards on `num_threads` threads (zero means one per hardware thread) and all tasks
+    // are published at once. Invalid expressions are skipped. There is no time zone per entry, tasks that need one
+    // are added with the `AddSchedule` overload that takes it. Exceptions thrown on a worker thread, such as
+    // `std::bad_alloc`, are rethrown here and nothing is added.
+    template <typename F>
+    auto AddScheduleBatchParallel(F&& fn, std::optional<std::size_t> num_tasks = {}, std::size_t num_threads = 0)
+        -> bool {
+        struct Entry {
+            std::string name;
+            std::string cron_expr;
+            TaskFn work;
+        };
+
+        std::vector<Entry> entries;
+        if (num_tasks) entries.reserve(num_tasks.value());
+        std::invoke(fn, [&entries](std::string name, std::string_view cron_expr, TaskFn work) {
+            entries.emplace_back(std::move(name), std::string(cron_expr), std::move(work));
+        });
+
+        // Parsers that can not be shared between threads parse everything up front.
+        std::vector<std::optional<ChronData>> parsed;
+        if constexpr (!traits::IsConcurrentParser<ParserType>::value) {
+            parsed.reserve(entries.size());
+            for (const auto& entry : entries) parsed.emplace_back(Parse(entry.name, entry.cron_expr));
+        }
+
+        auto now = clock_.Now();
+        std::vector<std::optional<Task>> built(entries.size());
+        details::ParallelFor(entries.size(), num_threads, [&](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i) {
+                auto data = parsed.empty() ? Parse(entries[i].name, entries[i].cron_expr) : std::move(parsed[i]);
+                if (!data) [[unlikely]] {
+                    continue;
+                }
+
+                Task task(std::move(entries[i].name), Schedule(data.value()), std::move(entries[i].work), nullptr,
+                          std::move(entries[i].cron_expr));
+                Disperse(task);
+                if (task.CalculateNext(now)) [[likely]] {
+                    built[i].emplace(std::move(task));
+                }
+            }
+        });
+
+        std::vector<Task> tasks;
+        tasks.reserve(built.size());
+        for (auto& task : built) {
+            if (task) tasks.emplace_back(std::move(task.value()));
+        }
+        if (tasks.empty()) [[unlikely]] {
+            return false;
+        }
+        std::ranges::sort(tasks, std::less<>{});
+
+        std::lock_guard lock{tasks_mtx_};
+        UnsafeDropTakenNames(tasks);
+        for (const auto& task : tasks) UnsafeOccupy(task);
+        auto middle = tasks_.insert(tasks_.end(), std::make_move_iterator(tasks.begin()),
+                                    std::make_move_iterator(tasks.end()));
+        std::inplace_merge(UnsafeFreshBegin(), middle, tasks_.end());
+        return true;
+    }
+
     void ClearSchedules() {
         std::lock_guard lock{tasks_mtx_};
         tasks_.clear();
+        stale_count_ = 0;
+        if (occupancy_) *occupancy_ = {};
     }
 
     void RemoveSchedule(std::string_view name) {
         std::lock_guard lock{tasks_mtx_};
-        std::erase_if(tasks_, [name](const Task& t) { return t.GetName() == name; });
+        UnsafeRemoveIf([name](const Task& t) { return t.GetName() == name; });
     }
 
+    // Applies a set of changes in one step, a tick never sees only a part of them. Tasks called like one of
+    // `removed` are removed, and every schedule added by `fn` through `add_schedule` replaces the tasks of the same
+    // name. Schedules that can not be added leave existing tasks of their name untouched.
+    template <typename F>
+    void UpdateSchedules(const std::unordered_set<std::string_view>& removed, F&& fn) {
+        std::vector<Task> tasks;
+        auto add_schedule = [this, &tasks](std::string name, std::string_view cron_expr, TaskFn work) -> bool {
+            auto task = MakeTask(std::move(name), cron_expr, std::move(work));
+            if (!task) [[unlikely]] {
+                return false;
+            }
+            tasks.emplace_back(std::move(task.value()));
+            return true;
+        };
+        std::invoke(fn, std::move(add_schedule));
+
+        std::unordered_set<std::string_view> replaced;
+        for (const auto& task : tasks) replaced.insert(task.GetName());
+
+        std::lock_guard lock{tasks_mtx_};
+        UnsafeRemoveIf([&removed, &replaced](const Task& t) {
+            return removed.contains(t.GetName()) || replaced.contains(t.GetName());
+        });
+        UnsafeDropTakenNames(tasks);
+        for (const auto& task : tasks) UnsafeOccupy(task);
+        tasks_.insert(tasks_.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+        UnsafeSortTasks();
+    }
+
+    // Tasks are recalculated lazily by the following ticks, see `SetRecalculationBudget`.
     void RecalculateSchedules() {
         std::lock_guard lock{tasks_mtx_};
-        for (auto& task : tasks_) task.CalculateNext(clock_.Now() + std::chrono::seconds(1));
+        UnsafeMarkStale(tasks_.size(), clock_.Now() + std::chrono::seconds(1));
+    }
+
+    // Recalculates all tasks right away on `num_threads` threads, zero means one per hardware thread.
+    void RecalculateSchedulesParallel(std::size_t num_threads = 0) {
+        std::lock_guard lock{tasks_mtx_};
+        auto from = clock_.Now() + std::chrono::seconds(1);
+        auto clock_offset = UnsafeGetClockOffset(from);
+        auto recalculate = [this, from, clock_offset](std::size_t first, std::size_t last) {
+            for (auto i = first; i < last; ++i) tasks_[i].CalculateNext(from, clock_offset);
+        };
+        // Redraws of randomized tasks share the occupancy, which is not thread safe.
+        details::ParallelFor(tasks_.size(), occupancy_ ? 1 : num_threads, recalculate);
+
+        stale_count_ = 0;
+        UnsafeSortTasks();
+    }
+
+    // Most tasks recalculated per tick after a clock change or `RecalculateSchedules`. Tasks waiting for their
+    // turn do not run, so a task due right after the change might run a few ticks late.
+    void SetRecalculationBudget(std::size_t budget) {
+        std::lock_guard lock{tasks_mtx_};
+        recalculation_budget_ = std::max<std::size_t>(budget, 1);
+    }
+
+    // Saves all tasks together with their upcoming and last runs, see `RestoreSnapshot`.
+    auto SaveSnapshot(const std::filesystem::path& path) -> bool {
+        SnapshotWriter writer;
+        TimePoint last_tick;
+        {
+            std::lock_guard lock{tasks_mtx_};
+            UnsafeRecalculateStale(tasks_.size());
+            writer.Reserve(tasks_.size());
+            for (const auto& task : tasks_) {
+                const auto* zone = task.GetTimeZone();
+                writer.Add({.name = task.GetName(),
+                            .expression = task.GetExpression(),
+                            .time_zone = zone ? zone->GetName() : std::string_view{},
+                            .masks = task.GetSchedule().GetMasks(),
+                            .next_schedule = task.GetNextSchedule(),
+                            .last_run = task.GetLastRun(),
+                            .delay = task.GetDelay(),
+                            .valid = task.IsValid(),
+                            .misfire_policy = task.GetMisfirePolicy()});
+            }
+            last_tick = first_tick_ ? clock_.Now() : last_tick_;
+        }
+        return writer.Write(path, last_tick);
+    }
+
+    // Replaces all tasks with the ones saved by `SaveSnapshot`, without parsing or calculating anything. Functions
+    // can not be saved, `registry(name)` returns the one to run for each task and tasks it returns none for are
+    // left out. Occurrences that passed while the snapshot was on disk are handled by the misfire policies on the
+    // next tick. Returns the number of restored tasks, or nothing if the file is missing or not a valid snapshot.
+    // Tasks of `AddRandomizedSchedule` keep the draw of their current period and parse their template again, to
+    // draw for the periods after it.
+    template <typename F>
+    auto RestoreSnapshot(const std::filesystem::path& path, F&& registry) -> std::optional<std::size_t> {
+        auto snapshot = Snapshot::Open(path);
+        if (!snapshot) [[unlikely]] {
+            return std::nullopt;
+        }
+
+        std::vector<Task> tasks;
+        tasks.reserve(snapshot->GetSize());
+
+        std::lock_guard lock{tasks_mtx_};
+        snapshot->ForEach([this, &tasks, &registry](const SnapshotTask& saved) {
+            TaskFn work = std::invoke(registry, saved.name);
+            if (!work) [[unlikely]] {
+                return;
+            }
+
+            std::shared_ptr<const TimeZone> zone;
+            if (!saved.time_zone.empty()) {
+                zone = UnsafeGetTimeZone(saved.time_zone);
+                if (!zone) [[unlikely]] {
+                    return;
+                }
+            }
+
+            auto& task = tasks.emplace_back(std::string(saved.name), Schedule(saved.masks), std::move(work),
+                                            std::move(zone), std::string(saved.expression));
+            task.SetMisfirePolicy(saved.misfire_policy);
+            Disperse(task);
+            task.Restore(saved.next_schedule, saved.last_run, saved.delay, saved.valid);
+            // The saved schedule is the draw of the current period, later ones are drawn again.
+            if (auto pattern = LoadRandomization(saved.expression)) [[unlikely]] {
+                task.ResumeRandomization(std::move(pattern), MakeHashKey(task.GetName(), hash_seed_));
+            }
+        });
+
+        tasks_.clear();
+        UnsafeDropTakenNames(tasks);
+        tasks_ = std::move(tasks);
+        stale_count_ = 0;
+        if (occupancy_) {
+            *occupancy_ = {};
+            for (auto& task : tasks_) {
+                UnsafeOccupy(task);
+                task.SetOccupancy(occupancy_.get());
+            }
+        }
+        // Snapshots are saved in queue order, sorting is only needed for files written by something else.
+        if (!std::ranges::is_sorted(tasks_, std::less<>{})) [[unlikely]] {
+            UnsafeSortTasks();
+        }
+        last_tick_ = snapshot->GetLastTick();
+        first_tick_ = false;
+        return tasks_.size();
+    }
+
+    // Adds the tasks of a schedule table written by `chron-compile`, see `RestoreSnapshot` for `registry`. Schedules
+    // were validated and parsed when the table was compiled, only the first runs are calculated. Returns the number
+    // of added tasks, or nothing if the file is missing or not a valid table.
+    template <typename F>
+    auto AddScheduleTable(const std::filesystem::path& path, F&& registry) -> std::optional<std::size_t> {
+        auto table = Snapshot::Open(path);
+        if (!table) [[unlikely]] {
+            return std::nullopt;
+        }
+
+        std::vector<Task> tasks;
+        tasks.reserve(table->GetSize());
+        auto now = clock_.Now();
+
+        std::lock_guard lock{tasks_mtx_};
+        table->ForEach([this, &tasks, &registry, now](const SnapshotTask& entry) {
+            TaskFn work = std::invoke(registry, entry.name);
+            if (!work) [[unlikely]] {
+                return;
+            }
+
+            std::shared_ptr<const TimeZone> zone;
+            if (!entry.time_zone.empty()) {
+                zone = UnsafeGetTimeZone(entry.time_zone);
+                if (!zone) [[unlikely]] {
+                    return;
+                }
+            }
+
+            auto clock_offset = zone ? clock_.UtcOffset(now) : std::chrono::seconds{0};
+            Task task(std::string(entry.name), Schedule(entry.masks), std::move(work), std::move(zone),
+                      std::string(entry.expression));
+            task.SetMisfirePolicy(entry.misfire_policy);
+            Disperse(task);
+            if (auto pattern = LoadRandomization(entry.expression)) [[unlikely]] {
+                task.ResumeRandomization(std::move(pattern), MakeHashKey(task.GetName(), hash_seed_));
+            }
+            if (task.CalculateNext(now, clock_offset)) [[likely]] {
+                tasks.emplace_back(std::move(task));
+            }
+        });
+
+        UnsafeDropTakenNames(tasks);
+        for (auto& task : tasks) {
+            UnsafeOccupy(task);
+            task.SetOccupancy(occupancy_.get());
+        }
+        tasks_.insert(tasks_.end(), std::make_move_iterator(tasks.begin()), std::make_move_iterator(tasks.end()));
+        UnsafeSortTasks();
+        return tasks.size();
+    }
+
+    // Records every run in the journal at `path` from now on. Tasks with a run in the journal continue right after
+    // it, so after a restart nothing runs twice and missed occurrences are handled by the misfire policies. Only
+    // tasks added before the journal is opened are brought up to date. Runs are synced once per tick, a crash loses
+    // at most the runs of the tick it happened in. The journal tells tasks apart by name, so names have to be
+    // unique: it is not opened while two tasks share a name, and while it is open tasks whose name is taken are
+    // not added.
+    auto OpenJournal(const std::filesystem::path& path) -> bool {
+        std::lock_guard lock{tasks_mtx_};
+        std::unordered_set<std::string_view> names;
+        for (const auto& task : tasks_) {
+            if (!names.insert(task.GetName()).second) [[unlikely]] {
+                return false;
+            }
+        }
+
+        auto journal = Journal::Open(path);
+        if (!journal) [[unlikely]] {
+            return false;
+        }
+
+        UnsafeRecalculateStale(tasks_.size());
+        for (auto& task : tasks_) {
+            if (auto run = journal->GetLastRun(task.GetName())) {
+                auto from = run->scheduled + task.GetDispersion() + std::chrono::seconds(1);
+                task.CalculateNext(from, UnsafeGetClockOffset(from));
+                task.RestoreLastRun(run->scheduled, run->fired);
+            }
+        }
+        UnsafeRemoveIf([](const Task& task) { return !task.IsValid(); });
+        UnsafeSortTasks();
+        journal_ = std::move(journal);
+        return true;
+    }
+
+    void CloseJournal() {
+        std::lock_guard lock{tasks_mtx_};
+        journal_.reset();
     }
 
     auto Tick(TimePoint now) -> std::size_t {
         std::lock_guard lock{tasks_mtx_};
 
+        // Offsets of all time zones in use are resolved once per tick
+        auto clock_offset = UnsafeResolveTimeZones(now);
+
         if (!first_tick_) [[likely]] {
             auto diff = now - last_tick_;
 
@@ -85,46 +476,135 @@ public:
                 now = last_tick_;
             }
 
-            if (std::chrono::abs(diff) >= std::chrono::hours{3}) {
-                for (auto& task : tasks_) task.CalculateNext(now);
+            // Going back in time always starts over, after a jump forward only tasks that want to be rescheduled
+            // do so. All other tasks deal with the gap according to their misfire policy.
+            if (diff <= -std::chrono::hours{3}) {
+                UnsafeMarkStale(tasks_.size(), now);
+            } else if (diff >= std::chrono::hours{3}) {
+                UnsafeRecalculateStale(tasks_.size());
+                auto stale_end = std::stable_partition(tasks_.begin(), tasks_.end(), [this](const Task& task) {
+                    return UnsafeGetMisfirePolicy(task).action == MisfireAction::Reschedule;
+                });
+                UnsafeMarkStale(static_cast<std::size_t>(stale_end - tasks_.begin()), now);
             }
         } else {
             first_tick_ = false;
         }
 
         last_tick_ = now;
-        if (tasks_.empty()) {
+        UnsafeRecalculateStale(recalculation_budget_);
+        auto executed_count = UnsafeRunExpired(now, clock_offset);
+        if (journal_) journal_->Flush();
+        return executed_count;
+    }
+
+    auto Tick() -> std::size_t { return Tick(clock_.Now()); }
+
+    // Runs every occurrence up to `until` in chronological order, as if the scheduler had been ticked at each one
+    // of them. Nothing is late during the replay, so misfire policies do not apply. Times before the last tick are
+    // ignored, going back in time is left to `Tick`.
+    auto TickUntil(TimePoint until) -> std::size_t {
+        std::lock_guard lock{tasks_mtx_};
+        if (!first_tick_ && until < last_tick_) [[unlikely]] {
             return 0;
         }
+        UnsafeRecalculateStale(tasks_.size());
 
-        std::size_t executed_count{};
-        std::erase_if(tasks_, [&executed_count, now](Task& task) {
-            if (!task.IsExpired(now)) {
-                return false;
-            }
+        // Tasks that will never run again stay behind the valid ones, which are kept in a heap with the earliest
+        // occurrence on top while replaying. Each occurrence then costs a logarithmic number of moves instead of a
+        // pass over the whole queue, tasks without further occurrences collect between the two parts.
+        auto valid_end = std::partition(tasks_.begin(), tasks_.end(), [](const Task& task) { return task.IsValid(); });
+        auto heap_end = valid_end;
+        std::make_heap(tasks_.begin(), heap_end, std::greater<>{});
 
-            task.Execute(now);
+        std::size_t executed_count{};
+        while (tasks_.begin() != heap_end && tasks_.front().IsExpired(until)) {
+            std::pop_heap(tasks_.begin(), heap_end, std::greater<>{});
+            auto& task = *(heap_end - 1);
+            auto now = task.GetDueTime();
+            auto clock_offset = UnsafeResolveTimeZones(now);
+            UnsafeExecute(task, now);
             executed_count++;
-            return !task.CalculateNext(now + std::chrono::seconds(1));
-        });
 
-        if (executed_count > 0) {
-            UnsafeSortTasks();
+            if (task.CalculateNext(now + std::chrono::seconds(1), clock_offset)) {
+                std::push_heap(tasks_.begin(), heap_end, std::greater<>{});
+            } else {
+                --heap_end;
+            }
         }
+        std::for_each(heap_end, valid_end, [this](const Task& task) { UnsafeVacate(task); });
+        tasks_.erase(heap_end, valid_end);
+        UnsafeSortTasks();
 
+        first_tick_ = false;
+        last_tick_ = until;
+        if (journal_) journal_->Flush();
         return executed_count;
     }
 
-    auto Tick() -> std::size_t { return Tick(clock_.Now()); }
+    // Sets the misfire policy of all tasks that do not have one of their own.
+    void SetMisfirePolicy(MisfirePolicy policy) {
+        std::lock_guard lock{tasks_mtx_};
+        misfire_policy_ = policy;
+    }
+
+    // Overrides the misfire policy of the tasks called `name`, `std::nullopt` reverts to the one of the scheduler.
+    auto SetMisfirePolicy(std::string_view name, std::optional<MisfirePolicy> policy) -> bool {
+        std::lock_guard lock{tasks_mtx_};
+        bool found{};
+        for (auto& task : tasks_) {
+            if (task.GetName() == name) {
+                task.SetMisfirePolicy(policy);
+                found = true;
+            }
+        }
+        return found;
+    }
 
     auto TimeUntilNext() const -> Duration {
         std::lock_guard lock{tasks_mtx_};
+        // Tasks waiting to be recalculated might be due already.
+        if (stale_count_ > 0) {
+            return Duration::zero();
+        }
         if (tasks_.empty()) {
             return Duration::max();
         }
         return tasks_[0].TimeUntilExpiry(clock_.Now());
     }
 
+    // Seed of the `H` fields, see `MakeHashKey`. Only schedules added afterwards use it, so it is best set before
+    // adding any.
+    void SetHashSeed(uint64_t seed) { hash_seed_ = seed; }
+
+    // Spreads the runs of tasks that share a schedule over `window` instead of running them all in the same tick.
+    // Every task runs a fixed offset within the window after each of its occurrences, derived from its name and the
+    // hash seed. Tasks still run in the order they are due and `TaskInfo::scheduled` reports the occurrence itself.
+    // Zero, the default, turns dispersion off. Only schedules added afterwards are dispersed, so it is best set
+    // before adding any, and the window should be shorter than the time between two occurrences of any task.
+    void SetDispersionWindow(std::chrono::seconds window) {
+        dispersion_window_ = std::max(window, std::chrono::seconds{0});
+    }
+
+    // Places the random fields drawn by `AddRandomizedSchedule`, and every redraw of them, on the seconds, minutes and
+    // hours the fewest tasks of this scheduler use, see `Randomization::Place`. All tasks are counted, whichever way
+    // they were added. Off by default, draws then ignore the other tasks.
+    void SetLoadAwarePlacement(bool enabled) {
+        std::lock_guard lock{tasks_mtx_};
+        if (enabled == (occupancy_ != nullptr)) {
+            return;
+        }
+        occupancy_ = enabled ? std::make_unique<Occupancy>() : nullptr;
+        for (auto& task : tasks_) {
+            UnsafeOccupy(task);
+            task.SetOccupancy(occupancy_.get());
+        }
+    }
+
+    // How many tasks use each second, minute and hour, nothing without load aware placement. Not synchronized with
+    // other threads that change the tasks.
+    auto GetOccupancy() const -> const Occupancy* { return occupancy_.get(); }
+
     auto GetClock() -> ClockType& { return clock_; }
     auto GetParser() -> ParserType& { return parser_; }
 
@@ -139,32 +619,257 @@ public:
 
         std::lock_guard lock{tasks_mtx_};
         status.reserve(tasks_.size());
-        for (const auto& task : tasks_) {
-            status.emplace_back(task.GetStatus(now));
+        auto clock_offset = UnsafeGetClockOffset(stale_from_);
+        for (std::size_t i = 0; i < stale_count_; ++i) {
+            // Stale tasks are shown with the time they will be recalculated to, without recalculating them.
+            const auto& task = tasks_[i];
+            auto due = task.PeekNext(stale_from_, clock_offset);
+            status.emplace_back(task.GetStatus(now, due.value_or(task.GetDueTime())));
+        }
+        for (auto it = UnsafeFreshBegin(); it != tasks_.end(); ++it) {
+            status.emplace_back(it->GetStatus(now));
         }
         return status;
     }
 
 private:
-    auto MakeTask(std::string name, std::string_view cron_expr, TaskFn work) const -> std::optional<Task> {
-        auto data = parser_(cron_expr);
+    auto MakeTask(std::string name,
+                  std::string_view cron_expr,
+                  TaskFn work,
+                  std::shared_ptr<const TimeZone> time_zone = nullptr) const -> std::optional<Task> {
+        auto data = Parse(name, cron_expr);
         if (!data) [[unlikely]] {
             return std::nullopt;
         }
 
-        Task task(std::move(name), Schedule(std::move(data.value())), std::move(work));
-        if (!task.CalculateNext(clock_.Now())) [[unlikely]] {
+        auto now = clock_.Now();
+        auto clock_offset = time_zone ? clock_.UtcOffset(now) : std::chrono::seconds{0};
+        Task task(std::move(name), Schedule(std::move(data.value())), std::move(work), std::move(time_zone),
+                  std::string(cron_expr));
+        Disperse(task);
+        if (!task.CalculateNext(now, clock_offset)) [[unlikely]] {
             return std::nullopt;
         }
         return task;
     }
 
-    void UnsafeSortTasks() { std::ranges::sort(tasks_, std::less<>{}); }
+    void Disperse(Task& task) const {
+        if (dispersion_window_ <= std::chrono::seconds{0}) [[likely]] {
+            return;
+        }
+        // Mixed once more, so that the offset does not follow the `H` fields of the task.
+        auto key = MakeHashKey(task.GetName(), hash_seed_);
+        auto offset = details::SplitMix64(key) % static_cast<uint64_t>(dispersion_window_.count());
+        task.SetDispersion(std::chrono::seconds(offset));
+    }
+
+    // Template of a task saved from `AddRandomizedSchedule`, whose expression is all it needs to keep drawing.
+    static auto LoadRandomization(std::string_view expression) -> std::shared_ptr<const RandomizationTemplate> {
+        if (!expression.contains("R(")) [[likely]] {
+            return nullptr;
+        }
+        auto pattern = RandomizationTemplate::Parse(expression);
+        if (!pattern || !pattern->HasRandomFields()) [[unlikely]] {
+            return nullptr;
+        }
+        return std::make_shared<const RandomizationTemplate>(std::move(pattern.value()));
+    }
+
+    // `H` fields of a task get the same values on every node that uses the same seed.
+    auto Parse(std::string_view name, std::string_view cron_expr) const -> std::optional<ChronData> {
+        if constexpr (traits::HashingParser<ParserType>) {
+            return parser_(cron_expr, MakeHashKey(name, hash_seed_));
+        } else {
+            return parser_(cron_expr);
+        }
+    }
+
+    auto UnsafeGetTimeZone(std::string_view name) -> std::shared_ptr<TimeZone> {
+        auto find = [this](std::string_view zone_name) {
+            return std::ranges::find(time_zones_, zone_name, [](const auto& zone) { return zone->GetName(); });
+        };
+
+        if (auto it = find(name); it != time_zones_.end()) {
+            return *it;
+        }
+
+        auto zone = TimeZone::Locate(name);
+        if (!zone) [[unlikely]] {
+            return nullptr;
+        }
+
+        // Links resolve to their target zone, which might already be in use under its canonical name.
+        if (auto it = find(zone->GetName()); it != time_zones_.end()) {
+            return *it;
+        }
+        return time_zones_.emplace_back(std::make_shared<TimeZone>(std::move(zone.value())));
+    }
+
+    auto UnsafeRunExpired(TimePoint now, std::chrono::seconds clock_offset) -> std::size_t {
+        if (tasks_.empty()) {
+            return 0;
+        }
+
+        std::size_t executed_count{};
+        auto run = [this, &executed_count, now, clock_offset](Task& task) {
+            if (!task.IsExpired(now)) {
+                return false;
+            }
+
+            const auto& policy = UnsafeGetMisfirePolicy(task);
+            if (policy.action == MisfireAction::Skip && now - task.GetDueTime() >= policy.tolerance) {
+                // Starting over from now still runs the task if the current second is an occurrence itself.
+                if (!task.CalculateNext(now, clock_offset)) {
+                    return true;
+                }
+                if (!task.IsExpired(now)) {
+                    return false;
+                }
+            }
+
+            UnsafeExecute(task, now);
+            executed_count++;
+
+            if (policy.action == MisfireAction::FireAll) {
+                for (std::size_t runs = 1; runs < policy.max_runs; ++runs) {
+                    if (!task.CalculateNext(task.GetDueTime() + std::chrono::seconds(1), clock_offset)) {
+                        return true;
+                    }
+                    if (!task.IsExpired(now)) {
+                        return false;
+                    }
+                    UnsafeExecute(task, now);
+                    executed_count++;
+                }
+            }
+
+            return !task.CalculateNext(now + std::chrono::seconds(1), clock_offset);
+        };
+        auto run_or_vacate = [this, &run](Task& task) {
+            if (!run(task)) {
+                return false;
+            }
+            UnsafeVacate(task);
+            return true;
+        };
+        tasks_.erase(std::remove_if(UnsafeFreshBegin(), tasks_.end(), run_or_vacate), tasks_.end());
+
+        if (executed_count > 0) {
+            UnsafeSortTasks();
+        }
+
+        return executed_count;
+    }
+
+    // With a journal open names identify tasks, see `OpenJournal`.
+    auto UnsafeIsNameTaken(std::string_view name) const -> bool {
+        return journal_ && std::ranges::find(tasks_, name, &Task::GetName) != tasks_.end();
+    }
+
+    // Drops the tasks of `tasks` whose name is taken, by the queue or by an earlier one of them, while a journal is
+    // open.
+    void UnsafeDropTakenNames(std::vector<Task>& tasks) const {
+        if (!journal_) [[likely]] {
+            return;
+        }
+        std::unordered_set<std::string> names;
+        for (const auto& task : tasks_) names.emplace(task.GetName());
+        std::erase_if(tasks, [&names](const Task& task) { return !names.emplace(task.GetName()).second; });
+    }
+
+    // Every task in the queue is counted in the occupancy, randomized ones count themselves while they draw.
+    void UnsafeOccupy(const Task& task) {
+        if (occupancy_) occupancy_->Add(task.GetSchedule().GetMasks());
+    }
+
+    void UnsafeVacate(const Task& task) {
+        if (occupancy_) occupancy_->Remove(task.GetSchedule().GetMasks());
+    }
+
+    void UnsafeExecute(Task& task, TimePoint now) {
+        if (journal_) journal_->Append(task.GetName(), task.GetNextSchedule(), now);
+        task.Execute(now);
+    }
+
+    template <typename Pred>
+    void UnsafeRemoveIf(Pred pred) {
+        auto remove = [this, &pred](const Task& task) {
+            if (!pred(task)) {
+                return false;
+            }
+            UnsafeVacate(task);
+            return true;
+        };
+
+        // Both parts of the queue are compacted on their own and then joined again.
+        auto fresh_begin = UnsafeFreshBegin();
+        auto stale_end = std::remove_if(tasks_.begin(), fresh_begin, remove);
+        auto fresh_end = std::remove_if(fresh_begin, tasks_.end(), remove);
+        if (stale_end != fresh_begin) {
+            fresh_end = std::move(fresh_begin, fresh_end, stale_end);
+        }
+        stale_count_ = static_cast<std::size_t>(stale_end - tasks_.begin());
+        tasks_.erase(fresh_end, tasks_.end());
+    }
+
+    // Tasks waiting to be recalculated are kept in front of the queue, the remaining ones are sorted.
+    auto UnsafeFreshBegin() -> std::vector<Task>::iterator { return tasks_.begin() + stale_count_; }
+    auto UnsafeFreshBegin() const -> std::vector<Task>::const_iterator { return tasks_.begin() + stale_count_; }
+
+    // The first `count` tasks are recalculated from `from` as soon as it is their turn.
+    void UnsafeMarkStale(std::size_t count, TimePoint from) {
+        stale_count_ = count;
+        stale_from_ = from;
+    }
+
+    void UnsafeRecalculateStale(std::size_t budget) {
+        if (stale_count_ == 0) {
+            return;
+        }
+
+        auto count = std::min(budget, stale_count_);
+        auto first = tasks_.begin() + (stale_count_ - count);
+        auto last = UnsafeFreshBegin();
+        auto clock_offset = UnsafeGetClockOffset(stale_from_);
+        for (auto it = first; it != last; ++it) it->CalculateNext(stale_from_, clock_offset);
+
+        stale_count_ -= count;
+        std::sort(first, last);
+        std::inplace_merge(first, last, tasks_.end());
+    }
+
+    auto UnsafeGetMisfirePolicy(const Task& task) const -> const MisfirePolicy& {
+        const auto& policy = task.GetMisfirePolicy();
+        return policy ? policy.value() : misfire_policy_;
+    }
+
+    auto UnsafeResolveTimeZones(TimePoint now) -> std::chrono::seconds {
+        auto clock_offset = UnsafeGetClockOffset(now);
+        for (auto& zone : time_zones_) zone->Resolve(now - clock_offset);
+        return clock_offset;
+    }
+
+    // Only tasks with a time zone need to know where the scheduler clock stands relative to UTC
+    auto UnsafeGetClockOffset(TimePoint now) const -> std::chrono::seconds {
+        return time_zones_.empty() ? std::chrono::seconds{0} : clock_.UtcOffset(now);
+    }
+
+    void UnsafeSortTasks() { std::sort(UnsafeFreshBegin(), tasks_.end(), std::less<>{}); }
 
     std::vector<Task> tasks_{};
+    std::vector<std::shared_ptr<TimeZone>> time_zones_{};
+    MisfirePolicy misfire_policy_{};
+    std::size_t recalculation_budget_{kDefaultRecalculationBudget};
+    std::size_t stale_count_{};
+    TimePoint stale_from_{};
     mutable MutexType tasks_mtx_{};
     ClockType clock_{};
     ParserType parser_{};
+    uint64_t hash_seed_{};
+    std::chrono::seconds dispersion_window_{};
+    // Randomized tasks keep a pointer to it, so it stays put when the scheduler moves.
+    std::unique_ptr<Occupancy> occupancy_{};
+    std::unique_ptr<Journal> journal_{};
     TimePoint last_tick_{};
     bool first_tick_{true};
 };
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common.hpp"
+#include "chron_masks.hpp"
+#include "details/mapped_file.hpp"
+#include "misfire_policy.hpp"
+
+namespace oryx::chron {
+
+// State of a single task as stored in a snapshot.
+struct SnapshotTask {
+    std::string_view name;
+    // Original expression text, kept for reference only. Restoring a task does not parse it again.
+    std::string_view expression;
+    // Empty for tasks on the scheduler clock.
+    std::string_view time_zone;
+    ChronMasks masks;
+    TimePoint next_schedule;
+    TimePoint last_run;
+    Duration delay;
+    bool valid;
+    std::optional<MisfirePolicy> misfire_policy;
+};
+
+// Builds a snapshot file. Schedules shared by several tasks are stored only once.
+class ORYX_CHRON_API SnapshotWriter {
+public:
+    static constexpr uint32_t kVersion = 2;
+
+    void Reserve(std::size_t num_tasks);
+    void Add(const SnapshotTask& task);
+
+    auto GetNumSchedules() const -> std::size_t { return schedules_.size(); }
+
+    // Writes next to `path` first and renames the file afterwards, so readers never see a partial snapshot.
+    auto Write(const std::filesystem::path& path, TimePoint last_tick) const -> bool;
+
+private:
+    std::vector<ChronMasks> schedules_;
+    std::unordered_map<ChronMasks, uint32_t> schedule_index_;
+    std::vector<std::byte> tasks_;
+    std::string strings_;
+};
+
+// Memory mapped snapshot file. Everything is validated by `Open`, names and expressions point straight into the
+// mapping.
+class ORYX_CHRON_API Snapshot {
+public:
+    static auto Open(const std::filesystem::path& path) -> std::optional<Snapshot>;
+
+    auto GetLastTick() const -> TimePoint { return last_tick_; }
+    auto GetSize() const -> std::size_t { return task_count_; }
+
+    // Calls `fn(task)` for each task, in queue order.
+    template <typename F>
+    void ForEach(F&& fn) const {
+        for (std::size_t i = 0; i < task_count_; ++i) fn(GetTask(i));
+    }
+
+    auto GetTask(std::size_t index) const -> SnapshotTask;
+
+private:
+    explicit Snapshot(details::MappedFile file)
+        : file_(std::move(file)) {}
+
+    details::MappedFile file_;
+    TimePoint last_tick_{};
+    const std::byte* schedules_{};
+    const std::byte* tasks_{};
+    const char* strings_{};
+    std::size_t task_count_{};
+};
+
+}  // namespace oryx::chron
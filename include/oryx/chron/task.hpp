@@ -1,42 +1,139 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 
 #include "common.hpp"
+#include "misfire_policy.hpp"
+#include "randomization.hpp"
 #include "schedule.hpp"
+#include "time_zone.hpp"
 
 namespace oryx::chron {
 
 struct TaskInfo {
     std::string_view name;
+    // How late the run is. Dispersed tasks count it from their dispersed time, see `Task::SetDispersion`.
     Duration delay;
+    // The occurrence this run belongs to.
+    TimePoint scheduled;
 };
 
 using TaskFn = std::function<void(TaskInfo)>;
 
 class ORYX_CHRON_API Task {
 public:
-    Task(std::string name, Schedule schedule, TaskFn task);
+    Task(std::string name,
+         Schedule schedule,
+         TaskFn task,
+         std::shared_ptr<const TimeZone> time_zone = nullptr,
+         std::string expression = {});
 
-    auto operator>(const Task &other) const -> bool { return next_schedule_ > other.next_schedule_; }
-    auto operator<(const Task &other) const -> bool { return next_schedule_ < other.next_schedule_; }
+    auto operator>(const Task &other) const -> bool { return GetDueTime() > other.GetDueTime(); }
+    auto operator<(const Task &other) const -> bool { return GetDueTime() < other.GetDueTime(); }
 
     void Execute(TimePoint now);
-    auto CalculateNext(TimePoint from) -> bool;
+    // For tasks with a time zone `clock_offset` is the offset of the scheduler clock, which is used to move
+    // between the scheduler timeline and UTC. `from` is a time on the scheduler timeline, dispersed tasks look for
+    // the occurrences whose dispersed time is at or after it.
+    auto CalculateNext(TimePoint from, std::chrono::seconds clock_offset = std::chrono::seconds{0}) -> bool;
+    // Due time `CalculateNext` would find, without changing the task. Randomized tasks answer from their current
+    // draw.
+    auto PeekNext(TimePoint from, std::chrono::seconds clock_offset = std::chrono::seconds{0}) const
+        -> std::optional<TimePoint>;
     auto TimeUntilExpiry(TimePoint now) const -> Duration;
 
     auto IsExpired(TimePoint now) const -> bool;
     auto GetName() const -> std::string_view { return name_; }
     auto GetDelay() const -> Duration { return delay_; }
-    auto GetStatus(TimePoint now) const -> std::string;
+    // The next occurrence, as scheduled by the expression.
+    auto GetNextSchedule() const -> TimePoint { return next_schedule_; }
+    // When the next occurrence runs, which is later than scheduled for dispersed tasks.
+    auto GetDueTime() const -> TimePoint { return next_schedule_ + dispersion_; }
+    auto GetStatus(TimePoint now) const -> std::string { return GetStatus(now, GetDueTime()); }
+    // Status as if the task was due at `due`.
+    auto GetStatus(TimePoint now, TimePoint due) const -> std::string;
+    auto GetTimeZone() const -> const TimeZone * { return time_zone_.get(); }
+    auto GetSchedule() const -> const Schedule & { return schedule_; }
+    auto GetExpression() const -> std::string_view { return expression_; }
+    auto GetLastRun() const -> TimePoint { return last_run_; }
+    auto IsValid() const -> bool { return valid_; }
+
+    // Puts back the state saved from another task, e.g. by a snapshot, instead of calculating it.
+    void Restore(TimePoint next_schedule, TimePoint last_run, Duration delay, bool valid);
+    // Puts back the last run of the task, which ran the occurrence `scheduled` at `fired`, e.g. from a journal.
+    // The next occurrence is left as it is.
+    void RestoreLastRun(TimePoint scheduled, TimePoint fired) {
+        last_run_ = fired;
+        delay_ = fired - (scheduled + dispersion_);
+    }
+
+    // Tasks without a policy of their own follow the one of the scheduler.
+    auto GetMisfirePolicy() const -> const std::optional<MisfirePolicy> & { return misfire_policy_; }
+    void SetMisfirePolicy(std::optional<MisfirePolicy> policy) { misfire_policy_ = policy; }
+
+    // Replaces the schedule with one drawn from `pattern`, and draws again whenever an occurrence falls into
+    // another period of it, see `RandomizationTemplate::GetPeriod`. Each period gets the draw seeded from `key` and
+    // the period itself, so tasks with the same key draw alike whenever they were made. Fails when no schedule could
+    // be drawn. With an `occupancy` the draws are placed through it, see `Randomization::Place`, and it keeps
+    // counting the current draw.
+    auto SetRandomization(std::shared_ptr<const RandomizationTemplate> pattern,
+                          uint64_t key,
+                          Occupancy *occupancy = nullptr) -> bool;
+    // Same as `SetRandomization`, except that the current schedule stays as the draw for the period of the next
+    // occurrence, e.g. for a task restored from a snapshot. Only later periods draw again. An `occupancy` has to
+    // count the current schedule already.
+    void ResumeRandomization(std::shared_ptr<const RandomizationTemplate> pattern,
+                             uint64_t key,
+                             Occupancy *occupancy = nullptr);
+    auto GetRandomization() const -> const RandomizationTemplate * {
+        return redraw_ ? redraw_->pattern.get() : nullptr;
+    }
+    // Places the following redraws through `occupancy`, which has to count the current schedule already.
+    void SetOccupancy(Occupancy *occupancy) {
+        if (redraw_) occupancy_ = occupancy;
+    }
+
+    // Runs every occurrence `offset` after it is scheduled, so that tasks with the same schedule do not all run at
+    // once. The offset should be shorter than the time between two occurrences, those would be skipped otherwise.
+    // Takes effect with the next `CalculateNext`.
+    void SetDispersion(Duration offset) { dispersion_ = offset; }
+    auto GetDispersion() const -> Duration { return dispersion_; }
 
 private:
+    // Shared by the copies of a task, what changes from draw to draw is kept with each of them.
+    struct Redraw {
+        std::shared_ptr<const RandomizationTemplate> pattern;
+        uint64_t key;
+    };
+
+    // Draws that land on days a month does not have are retried, see `Randomization::Generate`.
+    static constexpr int kMaxDraws = 16;
+    // Periods searched for one occurrence, each draw might have passed already or not occur in its period at all.
+    static constexpr int kMaxPeriods = 16;
+
+    auto DrawSchedule(int64_t period) -> bool;
+    void RedrawIfDue(TimePoint local);
+
     std::string name_;
     Schedule schedule_;
     TaskFn task_;
+    std::shared_ptr<const TimeZone> time_zone_;
+    std::string expression_;
+    std::optional<MisfirePolicy> misfire_policy_;
+    // Only randomized tasks allocate it.
+    std::shared_ptr<const Redraw> redraw_;
+    Occupancy *occupancy_{};
+    // Period the current schedule was drawn for.
+    std::optional<int64_t> drawn_period_;
+    // Calendar position of `next_schedule_`, lets the next search continue from there instead of starting over.
+    std::optional<Schedule::Cursor> cursor_;
     TimePoint next_schedule_;
     Duration delay_;
+    Duration dispersion_{};
     TimePoint last_run_;
     bool valid_;
 };
@@ -42,6 +42,9 @@ enum class Months : uint8_t {
     Last = December
 };
 
+// Range of the optional year field, the same as Quartz.
+enum class Years : uint16_t { First = 1970, Last = 2099 };
+
 inline constexpr std::array<Months, 7> kMonthsWith31{Months::January, Months::March,   Months::May,     Months::July,
                                                      Months::August,  Months::October, Months::December};
 
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string_view>
+#include <optional>
+#include <chrono>
+
+#include "common.hpp"
+
+namespace oryx::chron {
+
+// Wall clock time zone of a single task. Conversions are answered from the offset cached by the last call to
+// `Resolve` whenever the instant lies safely within the validity range of that offset, otherwise the time zone
+// database is consulted.
+class ORYX_CHRON_API TimeZone {
+public:
+    static auto Locate(std::string_view name) -> std::optional<TimeZone>;
+
+    auto GetName() const -> std::string_view;
+
+    // Refresh the cached offset if `utc` is no longer covered by it.
+    void Resolve(TimePoint utc);
+
+    auto ToLocal(TimePoint utc) const -> TimePoint;
+
+    // A wall time skipped by a transition maps to the transition itself. A wall time repeated by a transition
+    // maps to its first occurrence, unless that lies before `not_before` in which case the second one is used.
+    auto ToUtc(TimePoint local, TimePoint not_before) const -> TimePoint;
+
+private:
+    explicit TimeZone(const std::chrono::time_zone* zone);
+
+    const std::chrono::time_zone* zone_{};
+    TimePoint begin_{};
+    TimePoint end_{};
+    std::chrono::seconds offset_{};
+};
+
+}  // namespace oryx::chron
@@ -2,6 +2,8 @@
 
 #include <chrono>
 #include <concepts>
+#include <cstdint>
+#include <random>
 #include <optional>
 #include <string_view>
 #include <type_traits>
@@ -9,6 +11,10 @@
 #include "common.hpp"
 #include "chron_data.hpp"
 
+namespace oryx::chron {
+class ExpressionBuffer;
+}  // namespace oryx::chron
+
 namespace oryx::chron::traits {
 
 template <typename T>
@@ -34,9 +40,21 @@ concept Parser = requires(T t, std::string_view sv) {
     { t(sv) } -> std::same_as<std::optional<ChronData>>;
 };
 
+// Parsers that derive `H` fields from a key, such as the hash of a task name.
+template <typename T>
+concept HashingParser = Parser<T> && requires(T t, std::string_view sv, uint64_t key) {
+    { t(sv, key) } -> std::same_as<std::optional<ChronData>>;
+};
+
+// Random number generator that can be seeded with a single word.
+template <typename T>
+concept RandomGenerator = std::uniform_random_bit_generator<T> && std::constructible_from<T, uint64_t>;
+
+// Rewrites an expression into `out`. It is only called when the expression contains one of its `kTriggers`.
 template <typename T>
-concept Processor = requires(T t, std::string s) {
-    { T::Process(s) };
+concept Processor = requires(std::string_view expression, ExpressionBuffer& out) {
+    { T::kTriggers } -> std::convertible_to<std::string_view>;
+    { T::Process(expression, out) } noexcept;
 };
 
 }  // namespace oryx::chron::traits
\ No newline at end of file
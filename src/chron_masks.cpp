@@ -0,0 +1,108 @@
+#include <oryx/chron/chron_masks.hpp>
+
+#include <bit>
+#include <span>
+#include <vector>
+
+namespace oryx::chron {
+namespace {
+
+// Sorted values of a field that does not allow all of `[first, last]`.
+auto FormatValues(std::span<const unsigned> numbers, unsigned last) -> std::string {
+    auto count = numbers.size();
+
+    // Steps are only used where they run up to the end of the field, that is what `start/step` means.
+    if (count >= 3) {
+        auto step = numbers[1] - numbers[0];
+        auto evenly_spaced = step > 1;
+        for (std::size_t i = 2; i < count && evenly_spaced; ++i) evenly_spaced = numbers[i] - numbers[i - 1] == step;
+        if (evenly_spaced && numbers[count - 1] + step > last) {
+            return std::to_string(numbers[0]) + "/" + std::to_string(step);
+        }
+    }
+
+    std::string field;
+    for (std::size_t i = 0; i < count;) {
+        auto end = i + 1;
+        while (end < count && numbers[end] == numbers[end - 1] + 1) ++end;
+
+        if (!field.empty()) field += ',';
+        field += std::to_string(numbers[i]);
+        if (end - i > 1) {
+            field += '-';
+            field += std::to_string(numbers[end - 1]);
+        }
+        i = end;
+    }
+    return field;
+}
+
+auto FormatField(uint64_t mask, unsigned first, unsigned last) -> std::string {
+    auto full = (~uint64_t{0} >> (63 - last)) & (~uint64_t{0} << first);
+    if ((mask & full) == full) {
+        return "*";
+    }
+
+    unsigned numbers[64];
+    unsigned count{};
+    for (auto bits = mask & full; bits != 0; bits &= bits - 1) {
+        numbers[count++] = static_cast<unsigned>(std::countr_zero(bits));
+    }
+    return FormatValues({numbers, count}, last);
+}
+
+void AddEntry(std::string& field, const std::string& entry) {
+    if (!field.empty()) field += ',';
+    field += entry;
+}
+
+}  // namespace
+
+auto ChronMasks::ToCanonicalString() const -> std::string {
+    auto has_weekdays = (weeks & kAllWeekdays) != kAllWeekdays || last_weekdays != 0 || nth_weekdays != 0;
+
+    // Quartz style entries follow the numeric ones, in the order of their masks.
+    std::string day = "?";
+    if (HasMonthDays() || !has_weekdays) {
+        day = days != 0 ? FormatField(days, 1, 31) : std::string();
+        for (auto offsets = last_day_offsets; offsets != 0; offsets &= offsets - 1) {
+            auto offset = std::countr_zero(offsets);
+            AddEntry(day, offset == 0 ? std::string("L") : "L-" + std::to_string(offset));
+        }
+        for (auto nearest = nearest_weekdays; nearest != 0; nearest &= nearest - 1) {
+            auto nearest_day = std::countr_zero(nearest);
+            AddEntry(day, nearest_day == 0 ? std::string("LW") : std::to_string(nearest_day) + "W");
+        }
+    }
+
+    std::string weekday = "?";
+    if (has_weekdays) {
+        weekday = weeks != 0 ? FormatField(weeks, 0, 6) : std::string();
+        for (auto last = last_weekdays; last != 0; last &= last - 1) {
+            AddEntry(weekday, std::to_string(std::countr_zero(last)) + "L");
+        }
+        for (auto nth = nth_weekdays; nth != 0; nth &= nth - 1) {
+            auto bit = std::countr_zero(nth);
+            AddEntry(weekday, std::to_string(bit % 7) + "#" + std::to_string(bit / 7 + 1));
+        }
+    }
+
+    auto expression = FormatField(seconds, 0, 59) + ' ' + FormatField(minutes, 0, 59) + ' ' +
+                      FormatField(hours, 0, 23) + ' ' + day + ' ' + FormatField(months, 1, 12) + ' ' + weekday;
+    if (HasYears()) {
+        std::vector<unsigned> numbers;
+        for (auto year = kFirstYear; year <= kLastYear; ++year) {
+            if (HasYear(year)) numbers.push_back(static_cast<unsigned>(year));
+        }
+        expression += ' ' + FormatValues(numbers, kLastYear);
+    }
+    return expression;
+}
+
+auto ChronData::ToCanonicalString() const -> std::string { return ChronMasks(*this).ToCanonicalString(); }
+
+}  // namespace oryx::chron
+
+auto std::hash<oryx::chron::ChronData>::operator()(const oryx::chron::ChronData& data) const noexcept -> std::size_t {
+    return std::hash<oryx::chron::ChronMasks>{}(oryx::chron::ChronMasks(data));
+}
@@ -0,0 +1,100 @@
+#include <oryx/chron/details/file.hpp>
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef WIN32
+    #include <fcntl.h>
+    #include <io.h>
+    #include <sys/stat.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace oryx::chron::details {
+
+auto OpenFile(const std::filesystem::path& path, bool truncate) -> int {
+#ifdef WIN32
+    return _wopen(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY | (truncate ? _O_TRUNC : 0),
+                  _S_IREAD | _S_IWRITE);
+#else
+    return open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+#endif
+}
+
+auto WriteFile(int file, const void* data, std::size_t size) -> bool {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef WIN32
+        auto written = _write(file, bytes, static_cast<unsigned>(std::min<std::size_t>(size, 1 << 30)));
+#else
+        auto written = write(file, bytes, size);
+#endif
+        if (written < 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+auto SyncFile(int file) -> bool {
+#ifdef WIN32
+    return _commit(file) == 0;
+#elif defined(__APPLE__)
+    return fsync(file) == 0;
+#else
+    return fdatasync(file) == 0;
+#endif
+}
+
+auto TruncateFile(int file, std::size_t size) -> bool {
+#ifdef WIN32
+    return _chsize_s(file, static_cast<long long>(size)) == 0;
+#else
+    return ftruncate(file, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+void CloseFile(int file) {
+    if (file < 0) {
+        return;
+    }
+#ifdef WIN32
+    _close(file);
+#else
+    close(file);
+#endif
+}
+
+auto SyncDirectory(const std::filesystem::path& directory) -> bool {
+#ifdef WIN32
+    static_cast<void>(directory);
+    return true;
+#else
+    auto file = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+    auto ok = fsync(file) == 0;
+    close(file);
+    return ok;
+#endif
+}
+
+auto ReplaceFile(const std::filesystem::path& temporary, const std::filesystem::path& path) -> bool {
+    // The temporary file has to be in the directory before it replaces anything, and the rename has to be on disk
+    // before the caller moves on.
+    auto directory = path.parent_path();
+    if (!SyncDirectory(directory)) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    return !error && SyncDirectory(directory);
+}
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,78 @@
+#include <oryx/chron/details/file_watcher.hpp>
+
+#include <array>
+#include <cstring>
+#include <system_error>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace oryx::chron::details {
+
+FileWatcher::FileWatcher(std::filesystem::path path)
+    : path_(std::move(path)) {
+#ifdef __linux__
+    // Editors and deployment tools tend to replace files instead of writing them, so the directory is watched.
+    inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_ >= 0) {
+        auto directory = path_.has_parent_path() ? path_.parent_path() : std::filesystem::path(".");
+        if (inotify_add_watch(inotify_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0) {
+            close(inotify_);
+            inotify_ = -1;
+        }
+    }
+#endif
+    HasChangedOnDisk();
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+    if (inotify_ >= 0) {
+        close(inotify_);
+    }
+#endif
+}
+
+auto FileWatcher::HasChanged() -> bool {
+#ifdef __linux__
+    if (inotify_ >= 0) {
+        alignas(inotify_event) std::array<char, 4096> buffer{};
+        auto file_name = path_.filename().native();
+        bool changed{};
+
+        while (true) {
+            auto length = read(inotify_, buffer.data(), buffer.size());
+            if (length <= 0) {
+                break;
+            }
+
+            for (ssize_t offset = 0; offset < length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                changed |= event->len > 0 && file_name == event->name;
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+        return changed;
+    }
+#endif
+    return HasChangedOnDisk();
+}
+
+auto FileWatcher::HasChangedOnDisk() -> bool {
+    std::error_code ec;
+    auto last_write = std::filesystem::last_write_time(path_, ec);
+    auto size = ec ? 0 : std::filesystem::file_size(path_, ec);
+    if (ec) {
+        last_write = {};
+        size = 0;
+    }
+
+    auto changed = last_write != last_write_ || size != last_size_;
+    last_write_ = last_write;
+    last_size_ = size;
+    return changed;
+}
+
+}  // namespace oryx::chron::details
@@ -0,0 +1,209 @@
+#include <oryx/chron/journal.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <oryx/chron/details/file.hpp>
+#include <oryx/chron/details/mapped_file.hpp>
+
+namespace oryx::chron {
+namespace {
+
+using details::CloseFile;
+using details::OpenFile;
+using details::SyncFile;
+using details::TruncateFile;
+using details::WriteFile;
+
+constexpr std::array<char, 8> kMagic{'O', 'R', 'Y', 'X', 'J', 'R', 'N', 'L'};
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct Header {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t byte_order;
+    int64_t period_num;
+    int64_t period_den;
+};
+
+constexpr Header kHeader{
+    .magic = kMagic,
+    .version = Journal::kVersion,
+    .byte_order = kByteOrderMark,
+    .period_num = Duration::period::num,
+    .period_den = Duration::period::den,
+};
+
+static_assert(sizeof(Header) == 32);
+
+auto TemporaryPath(std::filesystem::path path) -> std::filesystem::path {
+    path += ".tmp";
+    return path;
+}
+
+auto ToTicks(TimePoint time) -> int64_t { return static_cast<int64_t>(time.time_since_epoch().count()); }
+auto FromTicks(int64_t ticks) -> TimePoint { return TimePoint(Duration(ticks)); }
+
+}  // namespace
+
+Journal::Journal(std::filesystem::path path, int file, std::size_t num_records)
+    : path_(std::move(path)),
+      file_(file),
+      num_records_(num_records) {}
+
+auto Journal::Open(const std::filesystem::path& path) -> std::unique_ptr<Journal> {
+    std::unordered_map<uint64_t, Record> last_runs;
+    std::size_t num_records{};
+
+    std::error_code error;
+    auto size = std::filesystem::file_size(path, error);
+    auto is_new = error || size == 0;
+    if (!is_new) {
+        auto mapped = details::MappedFile::Open(path);
+        if (!mapped) {
+            return nullptr;
+        }
+
+        auto data = mapped->GetData();
+        Header header{};
+        if (data.size() < sizeof(Header)) {
+            return nullptr;
+        }
+        std::memcpy(&header, data.data(), sizeof(Header));
+        if (header.magic != kMagic || header.version != kVersion || header.byte_order != kByteOrderMark ||
+            header.period_num != kHeader.period_num || header.period_den != kHeader.period_den) {
+            return nullptr;
+        }
+
+        // Runs are appended in order, so the last record of a task holds its latest run.
+        num_records = (data.size() - sizeof(Header)) / sizeof(Record);
+        for (std::size_t i = 0; i < num_records; ++i) {
+            Record record{};
+            std::memcpy(&record, data.data() + sizeof(Header) + i * sizeof(Record), sizeof(Record));
+            last_runs[record.task] = record;
+        }
+    }
+
+    auto file = OpenFile(path, false);
+    if (file < 0) {
+        return nullptr;
+    }
+
+    auto ok = is_new ? WriteFile(file, &kHeader, sizeof(Header)) && SyncFile(file)
+                     : TruncateFile(file, sizeof(Header) + num_records * sizeof(Record));
+    if (!ok) {
+        CloseFile(file);
+        return nullptr;
+    }
+
+    std::unique_ptr<Journal> journal(new Journal(path, file, num_records));
+    journal->last_runs_ = std::move(last_runs);
+    return journal;
+}
+
+Journal::~Journal() {
+    Flush();
+    if (compaction_.valid()) {
+        FinishCompaction();
+    }
+    CloseFile(file_);
+}
+
+void Journal::Append(std::string_view name, TimePoint scheduled, TimePoint fired) {
+    Record record{.task = TaskId(name), .scheduled = ToTicks(scheduled), .fired = ToTicks(fired)};
+    buffer_.push_back(record);
+    last_runs_[record.task] = record;
+}
+
+auto Journal::Flush() -> bool {
+    auto ok = true;
+    if (!buffer_.empty()) {
+        ok = WriteFile(file_, buffer_.data(), buffer_.size() * sizeof(Record)) && SyncFile(file_);
+        // Runs that did not make it into the file must not count towards a compaction.
+        if (ok) num_records_ += buffer_.size();
+        if (compaction_.valid()) {
+            compacted_later_.insert(compacted_later_.end(), buffer_.begin(), buffer_.end());
+        }
+        buffer_.clear();
+    }
+
+    if (compaction_.valid()) {
+        if (compaction_.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+            FinishCompaction();
+        }
+    } else if (num_records_ >= kMinCompactionSize && num_records_ > 2 * last_runs_.size()) {
+        StartCompaction();
+    }
+    return ok;
+}
+
+auto Journal::GetLastRun(std::string_view name) const -> std::optional<Run> {
+    auto it = last_runs_.find(TaskId(name));
+    if (it == last_runs_.end()) {
+        return std::nullopt;
+    }
+    return Run{.scheduled = FromTicks(it->second.scheduled), .fired = FromTicks(it->second.fired)};
+}
+
+// FNV-1a, the ids have to stay the same across builds and platforms.
+auto Journal::TaskId(std::string_view name) -> uint64_t {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto c : name) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+    }
+    return hash;
+}
+
+void Journal::StartCompaction() {
+    std::vector<Record> records;
+    records.reserve(last_runs_.size());
+    for (const auto& [task, record] : last_runs_) records.push_back(record);
+    num_compacted_ = records.size();
+
+    compaction_ = std::async(std::launch::async, [path = TemporaryPath(path_), records = std::move(records)] {
+        auto file = OpenFile(path, true);
+        if (file < 0) {
+            return false;
+        }
+        auto ok = WriteFile(file, &kHeader, sizeof(Header)) &&
+                  WriteFile(file, records.data(), records.size() * sizeof(Record)) && SyncFile(file);
+        CloseFile(file);
+        return ok;
+    });
+}
+
+void Journal::FinishCompaction() {
+    auto compacted = compaction_.get();
+    auto later = std::move(compacted_later_);
+    compacted_later_.clear();
+    if (!compacted) {
+        return;
+    }
+
+    // Runs written in the meantime are in the old file only, they have to make it into the new one first.
+    auto temporary = TemporaryPath(path_);
+    auto file = OpenFile(temporary, false);
+    if (file < 0) {
+        return;
+    }
+    if (!WriteFile(file, later.data(), later.size() * sizeof(Record)) || !SyncFile(file)) {
+        CloseFile(file);
+        return;
+    }
+
+    // Files that are open can not be replaced on every platform.
+    CloseFile(file_);
+    if (!details::ReplaceFile(temporary, path_)) {
+        CloseFile(file);
+        file_ = OpenFile(path_, false);
+        return;
+    }
+
+    file_ = file;
+    num_records_ = num_compacted_ + later.size();
+}
+
+}  // namespace oryx::chron
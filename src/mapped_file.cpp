@@ -0,0 +1,120 @@
+#include <oryx/chron/details/mapped_file.hpp>
+
+#include <utility>
+
+#ifdef WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace oryx::chron::details {
+
+auto MappedFile::Open(const std::filesystem::path& path) -> std::optional<MappedFile> {
+    MappedFile mapped;
+
+#ifdef WIN32
+    auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return mapped;
+    }
+
+    auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return std::nullopt;
+    }
+
+    auto* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        return std::nullopt;
+    }
+
+    mapped.mapping_ = mapping;
+    mapped.data_ = static_cast<const char*>(data);
+    mapped.size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+    auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return std::nullopt;
+    }
+
+    struct stat info {};
+    if (fstat(file, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(file);
+        return std::nullopt;
+    }
+    if (info.st_size == 0) {
+        close(file);
+        return mapped;
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    auto* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    mapped.mapping_ = data;
+    mapped.data_ = static_cast<const char*>(data);
+    mapped.size_ = size;
+#endif
+
+    return mapped;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      mapping_(std::exchange(other.mapping_, nullptr)) {}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile& {
+    if (this != &other) {
+        Unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        mapping_ = std::exchange(other.mapping_, nullptr);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+void MappedFile::Unmap() {
+    if (!mapping_) {
+        return;
+    }
+
+#ifdef WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+#else
+    munmap(mapping_, size_);
+#endif
+    mapping_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+}  // namespace oryx::chron::details
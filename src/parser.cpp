@@ -1,5 +1,6 @@
 #include <oryx/chron/parser.hpp>
 
+#include <cstdint>
 #include <optional>
 
 #include <oryx/chron/details/parser.hpp>
@@ -7,24 +8,43 @@
 #include <oryx/chron/common.hpp>
 
 namespace oryx::chron {
+namespace {
 
-auto ExpressionParser::operator()(std::string_view cron_expression) const -> std::optional<ChronData> {
-    static constexpr auto matcher = ctre::match<R"#(^\s*(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s*$)#">;
+// Every field gets its own key, so that `0 H H * * ?` does not end up at the same minute and hour for every name.
+auto GetFieldKey(uint64_t hash_key, uint64_t field) -> uint64_t {
+    auto state = hash_key + field;
+    return details::SplitMix64(state);
+}
+
+}  // namespace
+
+auto MakeHashKey(std::string_view name, uint64_t seed) -> uint64_t {
+    // FNV-1a over the bytes of the name, mixed once more so that similar names end up far apart.
+    auto hash = 0xCBF29CE484222325 ^ seed;
+    for (auto c : name) hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3;
+    return details::SplitMix64(hash);
+}
+
+auto ExpressionParser::operator()(std::string_view cron_expression, uint64_t hash_key) const
+    -> std::optional<ChronData> {
+    static constexpr auto matcher =
+        ctre::match<R"#(^\s*(\S+)\s+(\S+)\s+(\S+)\s+(\S+)\s+(\S+)\s+(\S+)(?:\s+(\S+))?\s*$)#">;
 
-    auto preprocessed =
-        PreprocessExpression<DollarExpressionProcessor, WeekMonthDayLiteralProcessor>(std::string(cron_expression));
-    auto match = matcher(std::move(preprocessed));
+    Preprocessor<DollarExpressionProcessor, WeekMonthDayLiteralProcessor> preprocessor;
+    auto match = matcher(preprocessor.Process(cron_expression));
     if (!match) [[unlikely]] {
         return std::nullopt;
     }
 
     ChronData data{};
-    bool valid = details::Parser::ValidateNumeric<Seconds>(match.get<1>().to_view(), data.seconds);
-    valid &= details::Parser::ValidateNumeric<Minutes>(match.get<2>().to_view(), data.minutes);
-    valid &= details::Parser::ValidateNumeric<Hours>(match.get<3>().to_view(), data.hours);
-    valid &= details::Parser::ValidateNumeric<MonthDays>(match.get<4>().to_view(), data.days);
-    valid &= details::Parser::ValidateNumeric<Months>(match.get<5>().to_view(), data.months);
-    valid &= details::Parser::ValidateNumeric<Weekdays>(match.get<6>().to_view(), data.weeks);
+    auto key = [hash_key](uint64_t field) { return GetFieldKey(hash_key, field); };
+    bool valid = details::Parser::ValidateNumeric<Seconds>(match.get<1>().to_view(), data.seconds, key(1));
+    valid &= details::Parser::ValidateNumeric<Minutes>(match.get<2>().to_view(), data.minutes, key(2));
+    valid &= details::Parser::ValidateNumeric<Hours>(match.get<3>().to_view(), data.hours, key(3));
+    valid &= details::Parser::ValidateMonthDays(match.get<4>().to_view(), data, key(4));
+    valid &= details::Parser::ValidateNumeric<Months>(match.get<5>().to_view(), data.months, key(5));
+    valid &= details::Parser::ValidateWeekdays(match.get<6>().to_view(), data, key(6));
+    valid &= details::Parser::ValidateYears(match.get<7>().to_view(), data.years);
     valid &= details::Parser::CheckDomVsDow(match.get<4>().to_view(), match.get<6>().to_view());
     valid &= details::Parser::ValidateDateVsMonths(data);
 
@@ -39,5 +59,7 @@ template class ORYX_CHRON_API CachedExpressionParser<std::mutex>;
 
 static_assert(traits::Parser<ExpressionParser>);
 static_assert(traits::Parser<CachedExpressionParser<NullMutex>>);
+static_assert(traits::HashingParser<ExpressionParser>);
+static_assert(traits::HashingParser<CachedExpressionParser<NullMutex>>);
 
 }  // namespace oryx::chron
\ No newline at end of file
@@ -1,11 +1,8 @@
 #include <oryx/chron/preprocessor.hpp>
 
 #include <algorithm>
+#include <array>
 #include <string_view>
-#include <span>
-
-#include <oryx/chron/details/ctre.hpp>
-#include <oryx/chron/details/to_underlying.hpp>
 
 namespace oryx::chron {
 namespace {
@@ -15,80 +12,83 @@ struct DollarExpressionPair {
     std::string_view cron;
 };
 
-template <typename Enum>
-    requires std::is_enum_v<Enum>
-auto ReplaceWithNumeric(std::string data, std::span<const std::string_view> names) -> std::string {
-    static auto find_icase = [](std::string_view haystack, std::string_view needle) {
-        return std::ranges::search(
-            haystack, needle, [](const int lhs, const int rhs) { return lhs == rhs; },
-            [](const int lhs) { return std::toupper(lhs); });
-    };
-
-    auto value = details::to_underlying(Enum::First);
-
-    std::string cached_str_value;
-    for (auto& name : names) {
-        std::string_view view{data};
-        size_t search_start = 0;
-
-        while (search_start < view.size()) {
-            auto subview = view.substr(search_start);
-            auto found = find_icase(subview, name);
+constexpr std::array<std::string_view, 13> kNumbers{"0", "1", "2", "3", "4", "5", "6",
+                                                   "7", "8", "9", "10", "11", "12"};
 
-            if (found.empty()) {
-                break;
-            }
+constexpr auto IsBlank(char c) -> bool {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
 
-            if (cached_str_value.empty()) {
-                cached_str_value = std::to_string(value);
-            }
+// Three letters packed into one number, upper case for ASCII letters.
+constexpr auto NameKey(std::string_view name) -> uint32_t {
+    auto upper = [](char c) { return static_cast<uint32_t>(static_cast<unsigned char>(c) & ~0x20u); };
+    return upper(name[0]) << 16 | upper(name[1]) << 8 | upper(name[2]);
+}
 
-            auto found_pos = search_start + std::distance(subview.begin(), found.begin());
-            data.replace(found_pos, name.size(), cached_str_value);
+template <std::size_t N>
+constexpr auto NameKeys(const std::array<std::string_view, N>& names) -> std::array<uint32_t, N> {
+    std::array<uint32_t, N> keys{};
+    for (std::size_t i = 0; i < N; ++i) keys[i] = NameKey(names[i]);
+    return keys;
+}
 
-            // Update part_view to reflect the changes and move search position
-            view = data;
-            search_start = found_pos + cached_str_value.size();
+constexpr auto kMonthKeys = NameKeys<12>(
+    {"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"});
+constexpr auto kDayKeys = NameKeys<7>({"SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT"});
+
+// All names are three letters long, so a single pass replaces every one of them wherever it appears in the field.
+template <std::size_t N>
+void ReplaceNames(std::string_view field, const std::array<uint32_t, N>& keys, unsigned first, ExpressionBuffer& out) {
+    std::size_t copied = 0;
+    for (std::size_t i = 0; i + 3 <= field.size();) {
+        auto is_letter = static_cast<unsigned>((static_cast<unsigned char>(field[i]) | 0x20u) - 'a') < 26;
+        auto found = is_letter ? std::ranges::find(keys, NameKey(field.substr(i, 3))) : keys.end();
+        if (found == keys.end()) {
+            ++i;
+            continue;
         }
-        cached_str_value.clear();
-        value++;
+        out.Append(field.substr(copied, i - copied));
+        out.Append(kNumbers[first + static_cast<unsigned>(found - keys.begin())]);
+        i += 3;
+        copied = i;
     }
-    return data;
+    out.Append(field.substr(copied));
 }
 
 }  // namespace
 
-auto DollarExpressionProcessor::Process(std::string data) noexcept -> std::string {
+void DollarExpressionProcessor::Process(std::string_view expression, ExpressionBuffer& out) noexcept {
     static constexpr std::array<DollarExpressionPair, 6> kExpressions{
         DollarExpressionPair("@yearly", "0 0 0 1 1 *"),  DollarExpressionPair("@annually", "0 0 0 1 1 *"),
         DollarExpressionPair("@monthly", "0 0 0 1 * *"), DollarExpressionPair("@weekly", "0 0 0 * * 0"),
         DollarExpressionPair("@daily", "0 0 0 * * ?"),   DollarExpressionPair("@hourly", "0 0 * * * ?")};
 
-    if (!data.empty() && data[0] == '@') {
-        auto it = std::ranges::find(kExpressions, data, &DollarExpressionPair::expr);
-        if (it != kExpressions.end()) [[likely]] {
-            return std::string(it->cron);
-        }
-    }
-    return data;
+    auto it = std::ranges::find(kExpressions, expression, &DollarExpressionPair::expr);
+    out.Append(it != kExpressions.end() ? it->cron : expression);
 }
 
-auto WeekMonthDayLiteralProcessor::Process(std::string data) noexcept -> std::string {
-    static constexpr std::array<std::string_view, 12> kMonthNames{"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
-                                                                  "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
-
-    static constexpr std::array<std::string_view, 7> kDayNames{"SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT"};
-    static constexpr auto matcher = ctre::match<R"#(^\s*(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s*$)#">;
+void WeekMonthDayLiteralProcessor::Process(std::string_view expression, ExpressionBuffer& out) noexcept {
+    // Blanks and all other fields are copied as they are.
+    std::size_t field = 0;
+    std::size_t copied = 0;
+    for (std::size_t i = 0; i < expression.size() && field < 6;) {
+        if (IsBlank(expression[i])) {
+            ++i;
+            continue;
+        }
 
-    auto match = matcher(data);
-    if (!match) [[unlikely]] {
-        return data;
+        auto end = i;
+        while (end < expression.size() && !IsBlank(expression[end])) ++end;
+        if (field == 4 || field == 5) {
+            out.Append(expression.substr(copied, i - copied));
+            auto text = expression.substr(i, end - i);
+            field == 4 ? ReplaceNames(text, kMonthKeys, 1, out) : ReplaceNames(text, kDayKeys, 0, out);
+            copied = end;
+        }
+        ++field;
+        i = end;
     }
-
-    auto month = ReplaceWithNumeric<Months>(match.get<5>().to_string(), kMonthNames);
-    auto dow = ReplaceWithNumeric<Weekdays>(match.get<6>().to_string(), kDayNames);
-    return std::format("{} {} {} {} {} {}", match.get<1>().to_view(), match.get<2>().to_view(),
-                       match.get<3>().to_view(), match.get<4>().to_view(), month, dow);
+    out.Append(expression.substr(copied));
 }
 
-}  // namespace oryx::chron
\ No newline at end of file
+}  // namespace oryx::chron
@@ -3,8 +3,11 @@
 #include <optional>
 #include <algorithm>
 #include <array>
-#include <iterator>
-#include <format>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <set>
+#include <utility>
 
 #include <oryx/chron/time_types.hpp>
 #include <oryx/chron/preprocessor.hpp>
@@ -17,125 +20,126 @@
 namespace oryx::chron {
 namespace {
 
-constexpr int kSelectedValueNone = -1;
+using Field = RandomizationTemplate::Field;
 
-template <typename T>
-auto GetRandomInRange(std::string_view section,
-                      int& selected_value,
-                      std::mt19937& twister,
-                      std::pair<int, int> limit = std::make_pair(-1, -1)) -> std::optional<std::string> {
-    selected_value = kSelectedValueNone;
+// Last day of month a random day is limited to, by the index into the day candidates.
+constexpr std::array<int, 3> kDayLimits{29, 30, 31};
 
+// Bounds of a `R(a-b)` field, nothing for fixed fields.
+auto GetRandomRange(std::string_view section) -> std::optional<std::pair<int, int>> {
     auto match = ctre::match<R"#([rR]\((\d+)\-(\d+)\))#">(section);
     if (!match) {
-        return std::string(section);
+        return std::nullopt;
     }
+    return std::pair{details::StringCast<int>(match.get<1>().to_view()),
+                     details::StringCast<int>(match.get<2>().to_view())};
+}
 
-    // Random range, parse left and right numbers
-    auto left = details::StringCast<int>(match.get<1>().to_view());
-    auto right = details::StringCast<int>(match.get<2>().to_view());
-
-    // Apply limit if provided
-    if (limit.first != -1 && limit.second != -1) {
-        left = std::clamp(left, limit.first, limit.second);
-        right = std::clamp(right, limit.first, limit.second);
+// Candidates of a random field, a range from right to left wraps around. The bounds are clamped to `limit` first,
+// so that a random day never ends up past the end of a month.
+template <chron::traits::TimeType T, std::unsigned_integral Mask>
+auto GetCandidates(std::pair<int, int> range, Mask& mask, std::optional<std::pair<int, int>> limit = {}) -> bool {
+    auto [left, right] = range;
+    if (limit) {
+        left = std::clamp(left, limit->first, limit->second);
+        right = std::clamp(right, limit->first, limit->second);
     }
 
     std::set<T> numbers;
-    bool success = details::Parser::ConvertFromStringRangeToNumberRange(std::format("{}-{}", left, right), numbers);
-
-    // Remove items outside the limit
-    if (limit.first != -1 && limit.second != -1) {
-        std::erase_if(numbers, [&limit](T val) -> bool {
-            return !details::InRange<int>(details::to_underlying(val), limit.first, limit.second);
-        });
-    }
-
-    if (!success || numbers.empty()) {
-        return std::nullopt;
+    if (!details::Parser::IsWithinBounds<T>(left, right) ||
+        !details::Parser::AddRange(numbers, static_cast<T>(left), static_cast<T>(right))) {
+        return false;
     }
 
-    std::uniform_int_distribution distribution(0, static_cast<int>(numbers.size() - 1));
-    auto it = numbers.begin();
-    std::advance(it, distribution(twister));
-    selected_value = details::to_underlying(*it);
-    return std::to_string(selected_value);
-}
-
-auto DayLimiter(const std::set<Months>& months) -> std::pair<int, int> {
-    int max = details::to_underlying(MonthDays::Last);
-
-    for (auto month : months) {
-        if (month == Months::February) {
-            // Limit to 29 days, possibly causing delaying schedule until next leap year.
-            max = std::min(max, 29);
-        } else if (std::ranges::find(kMonthsWith31, month) == kMonthsWith31.end()) {
-            // Not among the months with 31 days
-            max = std::min(max, 30);
+    mask = 0;
+    for (auto value : numbers) {
+        auto number = details::to_underlying(value);
+        if (!limit || details::InRange<int>(number, limit->first, limit->second)) {
+            mask |= static_cast<Mask>(Mask{1} << number);
         }
     }
-
-    return {details::to_underlying(MonthDays::First), max};
+    return mask != 0;
 }
 
 }  // namespace
 
-Randomization::Randomization()
-    : twister_(random_device_()) {}
-
-auto Randomization::Parse(std::string_view cron_schedule) -> std::optional<std::string> {
-    static constexpr auto matcher = ctre::match<R"#(^\s*(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s+(.*?)\s*$)#">;
+auto RandomizationTemplate::Parse(std::string_view cron_schedule) -> std::optional<RandomizationTemplate> {
+    static constexpr auto matcher =
+        ctre::match<R"#(^\s*(\S+)\s+(\S+)\s+(\S+)\s+(\S+)\s+(\S+)\s+(\S+)(?:\s+(\S+))?\s*$)#">;
 
-    auto preprocessed = PreprocessExpression<WeekMonthDayLiteralProcessor>(std::string(cron_schedule));
-    auto match = matcher(std::move(preprocessed));
+    Preprocessor<WeekMonthDayLiteralProcessor> preprocessor;
+    auto match = matcher(preprocessor.Process(cron_schedule));
     if (!match) [[unlikely]] {
         return std::nullopt;
     }
 
-    int selected_value = kSelectedValueNone;
-    auto second = GetRandomInRange<Seconds>(match.get<1>().to_view(), selected_value, twister_);
-    if (!second) [[unlikely]] {
+    std::array fields{match.get<1>().to_view(), match.get<2>().to_view(), match.get<3>().to_view(),
+                      match.get<4>().to_view(), match.get<5>().to_view(), match.get<6>().to_view()};
+    std::array<std::optional<std::pair<int, int>>, 6> ranges;
+    std::ranges::transform(fields, ranges.begin(), GetRandomRange);
+
+    // Random fields are parsed as complete ones, their candidates replace them afterwards.
+    auto fixed = [&](Field field) -> std::string_view {
+        auto index = details::to_underlying(field);
+        return ranges[index] ? "*" : fields[index];
+    };
+
+    ChronData data{};
+    bool valid = details::Parser::ValidateNumeric<Seconds>(fixed(Field::Seconds), data.seconds);
+    valid &= details::Parser::ValidateNumeric<Minutes>(fixed(Field::Minutes), data.minutes);
+    valid &= details::Parser::ValidateNumeric<Hours>(fixed(Field::Hours), data.hours);
+    valid &= details::Parser::ValidateMonthDays(fixed(Field::MonthDays), data);
+    valid &= details::Parser::ValidateNumeric<Months>(fixed(Field::Months), data.months);
+    valid &= details::Parser::ValidateWeekdays(fixed(Field::Weekdays), data);
+    valid &= details::Parser::ValidateYears(match.get<7>().to_view(), data.years);
+    valid &= details::Parser::CheckDomVsDow(fields[3], fields[5]);
+    if (!valid) [[unlikely]] {
         return std::nullopt;
     }
 
-    auto minute = GetRandomInRange<Minutes>(match.get<2>().to_view(), selected_value, twister_);
-    if (!minute) [[unlikely]] {
-        return std::nullopt;
+    RandomizationTemplate pattern;
+    pattern.masks_ = ChronMasks(data);
+    auto& masks = pattern.masks_;
+    if (auto range = ranges[0]) valid &= GetCandidates<Seconds>(*range, masks.seconds);
+    if (auto range = ranges[1]) valid &= GetCandidates<Minutes>(*range, masks.minutes);
+    if (auto range = ranges[2]) valid &= GetCandidates<Hours>(*range, masks.hours);
+    if (auto range = ranges[3]) {
+        for (std::size_t i = 0; i < kDayLimits.size(); ++i) {
+            valid &= GetCandidates<MonthDays>(*range, pattern.day_candidates_[i],
+                                              std::pair{details::to_underlying(MonthDays::First), kDayLimits[i]});
+        }
+        masks.days = pattern.day_candidates_.back();
     }
-
-    auto hour = GetRandomInRange<Hours>(match.get<3>().to_view(), selected_value, twister_);
-    if (!hour) [[unlikely]] {
+    if (auto range = ranges[4]) valid &= GetCandidates<Months>(*range, masks.months);
+    if (auto range = ranges[5]) valid &= GetCandidates<Weekdays>(*range, masks.weeks);
+    if (!valid) [[unlikely]] {
         return std::nullopt;
     }
 
-    // Do Month before MonthDays to allow capping the allowed range.
-    auto month = GetRandomInRange<Months>(match.get<5>().to_view(), selected_value, twister_);
-    if (!month) [[unlikely]] {
-        return std::nullopt;
+    for (std::size_t i = 0; i < ranges.size(); ++i) {
+        if (ranges[i]) pattern.random_fields_ |= static_cast<uint8_t>(1u << i);
     }
+    return pattern;
+}
 
-    std::set<Months> month_range{};
-    if (selected_value == kSelectedValueNone) {
-        // Month is not specific, get the range.
-        if (!details::Parser::ConvertFromStringRangeToNumberRange(match.get<5>().to_view(), month_range)) [[unlikely]] {
-            return std::nullopt;
-        }
-    } else {
-        month_range.emplace(static_cast<Months>(selected_value));
-    }
+void Occupancy::Update(const ChronMasks& masks, int delta) {
+    auto update = [delta](uint64_t mask, auto& counts) {
+        for (; mask != 0; mask &= mask - 1) counts[static_cast<std::size_t>(std::countr_zero(mask))] += delta;
+    };
+    update(masks.seconds, seconds_);
+    update(masks.minutes, minutes_);
+    update(masks.hours, hours_);
+}
 
-    auto limits = DayLimiter(month_range);
-    auto day_of_month = GetRandomInRange<MonthDays>(match.get<4>().to_view(), selected_value, twister_, limits);
-    if (!day_of_month) [[unlikely]] {
-        return std::nullopt;
-    }
+auto details::NextSeed() -> uint64_t {
+    static std::atomic<uint64_t> state{uint64_t{std::random_device{}()} << 32 | std::random_device{}()};
+    auto seed = state.fetch_add(1, std::memory_order_relaxed);
+    return details::SplitMix64(seed);
+}
 
-    auto day_of_week = GetRandomInRange<Weekdays>(match.get<6>().to_view(), selected_value, twister_);
-    if (!day_of_week) [[unlikely]] {
-        return std::nullopt;
-    }
+template class ORYX_CHRON_API BasicRandomization<Xoshiro256>;
 
-    return std::format("{} {} {} {} {} {}", *second, *minute, *hour, *day_of_month, *month, *day_of_week);
-}
+static_assert(traits::RandomGenerator<Xoshiro256>);
+static_assert(traits::RandomGenerator<std::mt19937>);
 
 }  // namespace oryx::chron
@@ -1,68 +1,60 @@
+#include <algorithm>
+#include <bit>
+#include <limits>
 #include <optional>
+#include <utility>
 
 #include <oryx/chron/schedule.hpp>
 #include <oryx/chron/common.hpp>
 #include <oryx/chron/details/to_underlying.hpp>
+#include <oryx/chron/details/civil.hpp>
+#include <oryx/chron/details/bits.hpp>
 
 using namespace std::chrono;
 
 namespace oryx::chron {
+namespace {
 
-auto Schedule::CalculateFrom(const TimePoint& from) const -> std::optional<TimePoint> {
-    auto curr = from;
+constexpr unsigned kSecondsPerDay = 86400;
+constexpr uint16_t kAllMonths = 0x1FFE;
 
-    bool done{};
-    auto max_iterations = std::numeric_limits<uint16_t>::max();
+// Distance between the values of a field that repeat evenly across the end of the field, such as 5,20,35,50 out of
+// 60. A single value repeats once per field. Zero for anything else.
+auto GetEvenSpacing(uint64_t mask, unsigned width) -> unsigned {
+    auto count = static_cast<unsigned>(std::popcount(mask));
+    if (count == 0 || width % count != 0) {
+        return 0;
+    }
 
-    while (!done && --max_iterations > 0) {
-        bool date_changed{};
-        year_month_day ymd = floor<days>(curr);
-
-        // Add months until one of the allowed days are found, or stay at the current one.
-        if (!data_.months.contains(static_cast<Months>(unsigned(ymd.month())))) {
-            auto next_month = ymd + months{1};
-            sys_days s = next_month.year() / next_month.month() / 1;
-            curr = s;
-            date_changed = true;
-        }
-        // If all days are allowed (or the field is ignored via '?'), then the 'day of week' takes precedence.
-        else if (data_.days.size() != details::to_underlying(MonthDays::Last)) {
-            // Add days until one of the allowed days are found, or stay at the current one.
-            if (!data_.days.contains(static_cast<MonthDays>(unsigned(ymd.day())))) {
-                sys_days s = ymd;
-                curr = s;
-                curr += days{1};
-                date_changed = true;
-            }
-        } else {
-            // Add days until the current weekday is one of the allowed weekdays
-            year_month_weekday ymw = floor<days>(curr);
-
-            if (!data_.weeks.contains(static_cast<Weekdays>(ymw.weekday().c_encoding()))) {
-                sys_days s = ymd;
-                curr = s;
-                curr += days{1};
-                date_changed = true;
-            }
-        }
+    auto step = width / count;
+    auto first = static_cast<unsigned>(std::countr_zero(mask));
+    uint64_t expected{};
+    for (auto value = first; value < width; value += step) expected |= uint64_t{1} << value;
+    return first < step && mask == expected ? step : 0;
+}
 
-        if (!date_changed) {
-            auto date_time = ToCalendarTime(curr);
-            if (!data_.hours.contains(static_cast<Hours>(date_time.hour))) {
-                curr += hours{1};
-                curr -= minutes{date_time.min};
-                curr -= seconds{date_time.sec};
-            } else if (!data_.minutes.contains(static_cast<Minutes>(date_time.min))) {
-                curr += minutes{1};
-                curr -= seconds{date_time.sec};
-            } else if (!data_.seconds.contains(static_cast<Seconds>(date_time.sec))) {
-                curr += seconds{1};
-            } else {
-                done = true;
-            }
+// Days of the month the cursor is in, only worked out again once the search moves on to another month.
+class MonthDaysCache {
+public:
+    auto Get(const ChronMasks& masks, const details::DayCursor& cursor) -> uint32_t {
+        const auto& date = cursor.GetDate();
+        auto month = date.year * 12 + static_cast<int>(date.month);
+        if (month != month_) {
+            month_ = month;
+            auto first_weekday = (date.weekday + 35 - (date.day - 1)) % 7;
+            days_ = masks.GetMonthDays(date.year, date.month, first_weekday, cursor.GetLastDayOfMonth());
         }
+        return days_;
     }
 
+private:
+    int month_{std::numeric_limits<int>::min()};
+    uint32_t days_{};
+};
+
+}  // namespace
+
+auto Schedule::CalculateFrom(const TimePoint& from) const -> std::optional<TimePoint> {
     // Discard fraction seconds in the calculated schedule time
     //  that may leftover from the argument `from`, which in turn comes from `now()`.
     // Fraction seconds will potentially make the task be triggered more than 1 second late
@@ -71,25 +63,435 @@ auto Schedule::CalculateFrom(const TimePoint& from) const -> std::optional<TimeP
     // By discarding fraction seconds in the scheduled time,
     //  the `tick()` within the same second will never be earlier than schedule time,
     //  and the task will trigger in that `tick()`.
-    curr -= curr.time_since_epoch() % seconds{1};
-    if (max_iterations > 0) {
-        return curr;
+    if (kind_ != Kind::General) {
+        // No calendar needed, only the time of day and the weekday.
+        auto day = floor<days>(from);
+        auto time = static_cast<unsigned>(floor<seconds>(from - day).count());
+        auto weekday = static_cast<unsigned>((day.time_since_epoch().count() % 7 + 11) % 7);
+        auto [days_ahead, next] = NextInDays(time, weekday);
+        return day + days(days_ahead) + seconds(next);
+    }
+
+    Cursor cursor(from);
+    if (!Advance(cursor)) {
+        return std::nullopt;
+    }
+    return cursor.ToTimePoint();
+}
+
+auto Schedule::CalculatePrevious(const TimePoint& at) const -> std::optional<TimePoint> {
+    Cursor cursor(at);
+    if (!Retreat(cursor)) {
+        return std::nullopt;
+    }
+    return cursor.ToTimePoint();
+}
+
+auto Schedule::NextN(const TimePoint& from, std::span<TimePoint> out) const -> std::size_t {
+    Cursor cursor(from);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        if (!Advance(cursor)) {
+            return i;
+        }
+        out[i] = cursor.ToTimePoint();
+        cursor.second++;
+    }
+    return out.size();
+}
+
+void Schedule::Classify() {
+    // Only schedules that run on every day of every month and year, at most restricted by day of week, have a
+    // shape of their own.
+    auto every_day = (masks_.months & kAllMonths) == kAllMonths && !masks_.HasMonthDays() &&
+                     !masks_.HasSpecialDays() && !masks_.HasYears();
+    auto weeks = masks_.weeks & ChronMasks::kAllWeekdays;
+    if (!every_day || weeks == 0 || masks_.seconds == 0 || masks_.minutes == 0 || masks_.hours == 0) {
+        return;
+    }
+
+    first_time_ = static_cast<uint32_t>(std::countr_zero(masks_.hours) * 3600 + std::countr_zero(masks_.minutes) * 60 +
+                                        std::countr_zero(masks_.seconds));
+    if (weeks != ChronMasks::kAllWeekdays) {
+        kind_ = Kind::Weekly;
+        return;
+    }
+
+    // The times of a day are evenly spaced, also across midnight, when the lowest field with more than one value
+    // is evenly spaced and all fields above it are complete.
+    auto seconds_step = GetEvenSpacing(masks_.seconds, 60);
+    auto minutes_step = GetEvenSpacing(masks_.minutes, 60);
+    auto hours_step = GetEvenSpacing(masks_.hours, 24);
+    if (seconds_step > 0 && seconds_step < 60) {
+        period_ = minutes_step == 1 && hours_step == 1 ? seconds_step : 0;
+    } else if (seconds_step == 60 && minutes_step > 0 && minutes_step < 60) {
+        period_ = hours_step == 1 ? minutes_step * 60 : 0;
+    } else if (seconds_step == 60 && minutes_step == 60) {
+        period_ = hours_step * 3600;
+    }
+    kind_ = period_ != 0 ? Kind::Interval : Kind::Daily;
+    period_reciprocal_ = period_ != 0 ? (uint64_t{1} << kReciprocalShift) / period_ + 1 : 0;
+}
+
+auto Schedule::NextTimeOfDay(unsigned& hour, unsigned& minute, unsigned& second) const -> bool {
+    // Same carrying as in `Advance`, without the calendar.
+    while (true) {
+        auto next_hour = details::NextBit(masks_.hours, hour);
+        if (next_hour > details::to_underlying(Hours::Last)) {
+            return false;
+        }
+        if (next_hour != hour) {
+            hour = next_hour;
+            minute = second = 0;
+        }
+
+        auto next_minute = details::NextBit(masks_.minutes, minute);
+        if (next_minute > details::to_underlying(Minutes::Last)) {
+            hour++;
+            minute = second = 0;
+            continue;
+        }
+        if (next_minute != minute) {
+            minute = next_minute;
+            second = 0;
+        }
+
+        auto next_second = details::NextBit(masks_.seconds, second);
+        if (next_second > details::to_underlying(Seconds::Last)) {
+            minute++;
+            second = 0;
+            continue;
+        }
+        second = next_second;
+        return true;
+    }
+}
+
+auto Schedule::RunsOn(unsigned weekday) const -> bool {
+    return kind_ != Kind::Weekly || (masks_.weeks >> weekday & 1u) != 0;
+}
+
+auto Schedule::DaysToNextRun(unsigned weekday) const -> unsigned {
+    if (kind_ != Kind::Weekly) {
+        return 1;
+    }
+    // Weekdays are doubled up so that the search wraps around into the next week.
+    auto weeks = static_cast<uint16_t>(masks_.weeks & ChronMasks::kAllWeekdays);
+    weeks |= static_cast<uint16_t>(weeks << 7);
+    return details::NextBit(weeks, weekday + 1) - weekday;
+}
+
+auto Schedule::NextInDays(unsigned time, unsigned weekday) const -> std::pair<unsigned, unsigned> {
+    if (kind_ == Kind::Interval) {
+        // A whole number of periods fit into a day, so rounding up to the next period also gives the first time of
+        // the following day. The division is a multiplication with the rounded up reciprocal of the period, exact
+        // for everything below 2^40 / period.
+        auto periods = (uint64_t{time} + period_ - 1 - first_time_) * period_reciprocal_ >> kReciprocalShift;
+        auto next = first_time_ + static_cast<unsigned>(periods) * period_;
+        return {next / kSecondsPerDay, next % kSecondsPerDay};
+    }
+
+    unsigned hour = time / 3600;
+    unsigned minute = time / 60 % 60;
+    unsigned second = time % 60;
+    if (RunsOn(weekday) && NextTimeOfDay(hour, minute, second)) {
+        return {0u, hour * 3600 + minute * 60 + second};
+    }
+    return {DaysToNextRun(weekday), first_time_};
+}
+
+auto Schedule::Advance(Cursor& cursor) const -> bool {
+    if (kind_ != Kind::General) {
+        // The calendar fields of the cursor are kept up to date, so the times of day are searched field by field.
+        unsigned hour = cursor.hour;
+        unsigned minute = cursor.minute;
+        unsigned second = cursor.second;
+        auto weekday = cursor.date.GetDate().weekday;
+        if (!RunsOn(weekday) || !NextTimeOfDay(hour, minute, second)) {
+            cursor.date.AddDays(DaysToNextRun(weekday));
+            hour = first_time_ / 3600;
+            minute = first_time_ / 60 % 60;
+            second = first_time_ % 60;
+        }
+        cursor.hour = static_cast<uint8_t>(hour);
+        cursor.minute = static_cast<uint8_t>(minute);
+        cursor.second = static_cast<uint8_t>(second);
+        return true;
+    }
+
+    auto next_day = [&cursor] {
+        cursor.date.NextDay();
+        cursor.hour = cursor.minute = cursor.second = 0;
+    };
+    auto next_month = [&cursor] {
+        cursor.date.NextMonth();
+        cursor.hour = cursor.minute = cursor.second = 0;
+    };
+
+    // Every step either finds a match or moves on to the next candidate of a field, values running past the end
+    // of their field are carried into the next higher one by the following step.
+    MonthDaysCache month_days;
+    auto max_iterations = std::numeric_limits<uint16_t>::max();
+    while (--max_iterations > 0) {
+        const auto& date = cursor.date.GetDate();
+        if (!(masks_.months >> date.month & 1u)) {
+            next_month();
+            continue;
+        }
+        if (!masks_.HasYear(date.year)) {
+            auto year = masks_.NextYear(date.year);
+            if (!year) {
+                return false;
+            }
+            cursor.date = details::DayCursor(details::DaysFromCivil(*year, 1, 1));
+            cursor.hour = cursor.minute = cursor.second = 0;
+            continue;
+        }
+
+        unsigned day{};
+        if (masks_.HasSpecialDays()) {
+            day = details::NextBit(month_days.Get(masks_, cursor.date), date.day);
+        } else if (masks_.HasMonthDays()) {
+            day = details::NextBit(masks_.days, date.day);
+        } else {
+            // Weekdays are doubled up so that the search wraps around into the next week.
+            auto weeks = static_cast<uint16_t>(masks_.weeks | masks_.weeks << 7);
+            auto weekday = details::NextBit(weeks, date.weekday);
+            day = weekday < 14 ? date.day + weekday - date.weekday : details::to_underlying(MonthDays::Last) + 1;
+        }
+
+        if (day > cursor.date.GetLastDayOfMonth()) {
+            next_month();
+            continue;
+        }
+        if (day != date.day) {
+            cursor.date.SetDay(day);
+            cursor.hour = cursor.minute = cursor.second = 0;
+        }
+
+        auto hour = details::NextBit(masks_.hours, cursor.hour);
+        if (hour > details::to_underlying(Hours::Last)) {
+            next_day();
+            continue;
+        }
+        if (hour != cursor.hour) {
+            cursor.hour = static_cast<uint8_t>(hour);
+            cursor.minute = cursor.second = 0;
+        }
+
+        auto minute = details::NextBit(masks_.minutes, cursor.minute);
+        if (minute > details::to_underlying(Minutes::Last)) {
+            cursor.hour++;
+            cursor.minute = cursor.second = 0;
+            continue;
+        }
+        if (minute != cursor.minute) {
+            cursor.minute = static_cast<uint8_t>(minute);
+            cursor.second = 0;
+        }
+
+        auto second = details::NextBit(masks_.seconds, cursor.second);
+        if (second > details::to_underlying(Seconds::Last)) {
+            cursor.minute++;
+            cursor.second = 0;
+            continue;
+        }
+
+        cursor.second = static_cast<uint8_t>(second);
+        return true;
     }
-    return std::nullopt;
+
+    return false;
+}
+
+auto Schedule::Retreat(Cursor& cursor) const -> bool {
+    auto end_of_day = [&cursor] {
+        cursor.hour = details::to_underlying(Hours::Last);
+        cursor.minute = details::to_underlying(Minutes::Last);
+        cursor.second = details::to_underlying(Seconds::Last);
+    };
+    auto prev_day = [&] {
+        cursor.date.PrevDay();
+        end_of_day();
+    };
+    auto prev_month = [&] {
+        cursor.date.PrevMonth();
+        end_of_day();
+    };
+    auto prev_hour = [&] {
+        if (cursor.hour == 0) {
+            prev_day();
+            return;
+        }
+        cursor.hour--;
+        cursor.minute = details::to_underlying(Minutes::Last);
+        cursor.second = details::to_underlying(Seconds::Last);
+    };
+    auto prev_minute = [&] {
+        if (cursor.minute == 0) {
+            prev_hour();
+            return;
+        }
+        cursor.minute--;
+        cursor.second = details::to_underlying(Seconds::Last);
+    };
+
+    // Mirror image of `Advance`, fields running out of candidates borrow from the next higher one.
+    MonthDaysCache month_days;
+    auto max_iterations = std::numeric_limits<uint16_t>::max();
+    while (--max_iterations > 0) {
+        const auto& date = cursor.date.GetDate();
+        if (!(masks_.months >> date.month & 1u)) {
+            prev_month();
+            continue;
+        }
+        if (!masks_.HasYear(date.year)) {
+            auto year = masks_.PrevYear(date.year);
+            if (!year) {
+                return false;
+            }
+            cursor.date = details::DayCursor(details::DaysFromCivil(*year, 12, 31));
+            end_of_day();
+            continue;
+        }
+
+        unsigned day{};
+        if (masks_.HasSpecialDays()) {
+            day = details::PrevBit(month_days.Get(masks_, cursor.date), date.day);
+        } else if (masks_.HasMonthDays()) {
+            day = details::PrevBit(masks_.days, date.day);
+        } else {
+            // Weekdays are doubled up so that the search wraps around into the previous week.
+            auto weeks = static_cast<uint16_t>(masks_.weeks | masks_.weeks << 7);
+            auto weekday = details::PrevBit(weeks, date.weekday + 7);
+            auto delta = date.weekday + 7 - weekday;
+            day = weekday < 14 && delta < date.day ? date.day - delta : details::to_underlying(MonthDays::Last) + 1;
+        }
+
+        if (day > date.day) {
+            prev_month();
+            continue;
+        }
+        if (day != date.day) {
+            cursor.date.SetDay(day);
+            end_of_day();
+        }
+
+        auto hour = details::PrevBit(masks_.hours, cursor.hour);
+        if (hour > cursor.hour) {
+            prev_day();
+            continue;
+        }
+        if (hour != cursor.hour) {
+            cursor.hour = static_cast<uint8_t>(hour);
+            cursor.minute = details::to_underlying(Minutes::Last);
+            cursor.second = details::to_underlying(Seconds::Last);
+        }
+
+        auto minute = details::PrevBit(masks_.minutes, cursor.minute);
+        if (minute > cursor.minute) {
+            prev_hour();
+            continue;
+        }
+        if (minute != cursor.minute) {
+            cursor.minute = static_cast<uint8_t>(minute);
+            cursor.second = details::to_underlying(Seconds::Last);
+        }
+
+        auto second = details::PrevBit(masks_.seconds, cursor.second);
+        if (second > cursor.second) {
+            prev_minute();
+            continue;
+        }
+
+        cursor.second = static_cast<uint8_t>(second);
+        return true;
+    }
+
+    return false;
+}
+
+auto Schedule::GetGaps() const -> std::optional<Gaps> {
+    static constexpr int64_t kDaysPerCycle = 146097;
+    static constexpr int kFirstYear = 2000;
+
+    if (!masks_.IsSatisfiable()) {
+        return std::nullopt;
+    }
+
+    // Gaps between the occurrences of a single day.
+    int64_t first_time{-1};
+    int64_t last_time{-1};
+    auto min = std::numeric_limits<int64_t>::max();
+    int64_t max{};
+    for (auto hours = masks_.hours; hours != 0; hours &= hours - 1) {
+        for (auto minutes = masks_.minutes; minutes != 0; minutes &= minutes - 1) {
+            for (auto seconds = masks_.seconds; seconds != 0; seconds &= seconds - 1) {
+                auto time = std::countr_zero(hours) * 3600 + std::countr_zero(minutes) * 60 + std::countr_zero(seconds);
+                if (last_time >= 0) {
+                    min = std::min(min, time - last_time);
+                    max = std::max(max, time - last_time);
+                } else {
+                    first_time = time;
+                }
+                last_time = time;
+            }
+        }
+    }
+
+    // Gaps between the days it runs on, one month of days at a time. Without a year field the gap from the last day
+    // of the cycle to the first one of the next cycle counts as well, with one only the years of the field count.
+    auto first_year = masks_.HasYears() ? ChronMasks::kFirstYear : kFirstYear;
+    auto last_year = masks_.HasYears() ? ChronMasks::kLastYear : kFirstYear + 399;
+    int64_t first_day{std::numeric_limits<int64_t>::min()};
+    int64_t last_day{std::numeric_limits<int64_t>::min()};
+    auto min_days = std::numeric_limits<int64_t>::max();
+    int64_t max_days{};
+    for (int year = first_year; year <= last_year; ++year) {
+        for (unsigned month = 1; month <= 12; ++month) {
+            auto month_start = details::DaysFromCivil(year, month, 1) - 1;
+            for (auto days = masks_.GetMonthDays(year, month); days != 0; days &= days - 1) {
+                auto day = month_start + std::countr_zero(days);
+                if (last_day != std::numeric_limits<int64_t>::min()) {
+                    min_days = std::min(min_days, day - last_day);
+                    max_days = std::max(max_days, day - last_day);
+                } else {
+                    first_day = day;
+                }
+                last_day = day;
+            }
+        }
+    }
+    if (!masks_.HasYears()) {
+        auto wrap = first_day + kDaysPerCycle - last_day;
+        min_days = std::min(min_days, wrap);
+        max_days = std::max(max_days, wrap);
+    }
+
+    // Going from the last occurrence of a day to the first one of the next day it runs on.
+    if (min_days != std::numeric_limits<int64_t>::max()) {
+        auto across_days = first_time - last_time;
+        min = std::min(min, min_days * kSecondsPerDay + across_days);
+        max = std::max(max, max_days * kSecondsPerDay + across_days);
+    }
+    if (min == std::numeric_limits<int64_t>::max()) {
+        // Runs only once within the years of its year field.
+        return std::nullopt;
+    }
+    return Gaps{.min = std::chrono::seconds(min), .max = std::chrono::seconds(max)};
 }
 
 auto Schedule::ToCalendarTime(TimePoint time) -> DateTime {
-    auto daypoint = floor<days>(time);
-    auto ymd = year_month_day(daypoint);           // calendar date
-    auto time_of_day = hh_mm_ss(time - daypoint);  // Yields time_of_day type
-
-    // Obtain individual components as integers
-    return {.year = int(ymd.year()),
-            .month = unsigned(ymd.month()),
-            .day = unsigned(ymd.day()),
-            .hour = static_cast<uint8_t>(time_of_day.hours().count()),
-            .min = static_cast<uint8_t>(time_of_day.minutes().count()),
-            .sec = static_cast<uint8_t>(time_of_day.seconds().count())};
+    auto day_point = floor<days>(time);
+    auto date = details::CivilFromDays(day_point.time_since_epoch().count());
+    auto time_of_day = static_cast<unsigned>(floor<seconds>(time - day_point).count());
+
+    return {.year = date.year,
+            .month = date.month,
+            .day = date.day,
+            .hour = static_cast<uint8_t>(time_of_day / 3600),
+            .min = static_cast<uint8_t>(time_of_day / 60 % 60),
+            .sec = static_cast<uint8_t>(time_of_day % 60),
+            .weekday = static_cast<uint8_t>(date.weekday)};
 }
 
 }  // namespace oryx::chron
\ No newline at end of file
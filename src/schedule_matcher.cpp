@@ -0,0 +1,152 @@
+#include <bit>
+
+#include <oryx/chron/schedule_matcher.hpp>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define ORYX_CHRON_MATCH_AVX2
+    #include <immintrin.h>
+#endif
+
+namespace oryx::chron {
+namespace {
+
+constexpr auto kWeekdayShift = 32u;
+constexpr auto kMonthShift = 32u;
+constexpr uint64_t kAllWeekdays = 0x7F;
+
+struct Columns {
+    const uint64_t* seconds;
+    const uint64_t* minutes;
+    const uint64_t* hours_months;
+    const uint64_t* days_weeks;
+};
+
+struct Probe {
+    uint64_t seconds;
+    uint64_t minutes;
+    uint64_t hours_months;
+    uint64_t days_weeks;
+};
+
+auto MakeProbe(const DateTime& dt) -> Probe {
+    return {.seconds = uint64_t{1} << dt.sec,
+            .minutes = uint64_t{1} << dt.min,
+            .hours_months = uint64_t{1} << dt.hour | uint64_t{1} << (kMonthShift + dt.month),
+            .days_weeks = uint64_t{1} << dt.day | uint64_t{1} << (kWeekdayShift + dt.weekday)};
+}
+
+void MatchScalar(const Columns& columns, const Probe& probe, std::size_t first, std::size_t last, uint64_t* bitmap) {
+    for (auto i = first; i < last; ++i) {
+        auto match = (columns.seconds[i] & probe.seconds) == probe.seconds &&
+                     (columns.minutes[i] & probe.minutes) == probe.minutes &&
+                     (columns.hours_months[i] & probe.hours_months) == probe.hours_months &&
+                     (columns.days_weeks[i] & probe.days_weeks) == probe.days_weeks;
+        bitmap[i / 64] |= static_cast<uint64_t>(match) << (i % 64);
+    }
+}
+
+#ifdef ORYX_CHRON_MATCH_AVX2
+__attribute__((target("avx2"))) auto TestColumn(const uint64_t* column, __m256i wanted) -> __m256i {
+    auto values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column));
+    return _mm256_cmpeq_epi64(_mm256_and_si256(values, wanted), wanted);
+}
+
+__attribute__((target("avx2"))) void MatchAvx2(const Columns& columns,
+                                               const Probe& probe,
+                                               std::size_t count,
+                                               uint64_t* bitmap) {
+    const auto seconds = _mm256_set1_epi64x(static_cast<long long>(probe.seconds));
+    const auto minutes = _mm256_set1_epi64x(static_cast<long long>(probe.minutes));
+    const auto hours_months = _mm256_set1_epi64x(static_cast<long long>(probe.hours_months));
+    const auto days_weeks = _mm256_set1_epi64x(static_cast<long long>(probe.days_weeks));
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto match = _mm256_and_si256(
+            _mm256_and_si256(TestColumn(columns.seconds + i, seconds), TestColumn(columns.minutes + i, minutes)),
+            _mm256_and_si256(TestColumn(columns.hours_months + i, hours_months),
+                             TestColumn(columns.days_weeks + i, days_weeks)));
+        auto bits = static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(match)));
+        bitmap[i / 64] |= bits << (i % 64);
+    }
+    MatchScalar(columns, probe, i, count, bitmap);
+}
+
+auto HasAvx2() -> bool {
+    static const bool kHasAvx2 = __builtin_cpu_supports("avx2");
+    return kHasAvx2;
+}
+#endif
+
+}  // namespace
+
+void ScheduleMatcher::Reserve(std::size_t count) {
+    seconds_.reserve(count);
+    minutes_.reserve(count);
+    hours_months_.reserve(count);
+    days_weeks_.reserve(count);
+}
+
+auto ScheduleMatcher::Add(const ChronMasks& masks) -> std::size_t {
+    // Only the field that decides about the day is taken into account, the other one accepts every day. Days that
+    // depend on the month or the year are checked separately, the columns accept every day for them.
+    auto calendar = masks.HasSpecialDays() || masks.HasYears();
+    auto days = masks.HasMonthDays() && !calendar ? masks.days : ChronMasks::kAllMonthDays;
+    auto weeks = masks.HasMonthDays() || calendar ? kAllWeekdays : masks.weeks;
+    if (calendar) {
+        calendar_.emplace_back(seconds_.size(), masks);
+    }
+
+    seconds_.push_back(masks.seconds);
+    minutes_.push_back(masks.minutes);
+    hours_months_.push_back(uint64_t{masks.hours} | uint64_t{masks.months} << kMonthShift);
+    days_weeks_.push_back(uint64_t{days} | uint64_t{weeks} << kWeekdayShift);
+    return seconds_.size() - 1;
+}
+
+void ScheduleMatcher::Clear() {
+    seconds_.clear();
+    minutes_.clear();
+    hours_months_.clear();
+    days_weeks_.clear();
+    calendar_.clear();
+}
+
+void ScheduleMatcher::Match(TimePoint time, std::vector<uint64_t>& bitmap) const {
+    bitmap.assign((GetSize() + 63) / 64, 0);
+
+    const Columns columns{seconds_.data(), minutes_.data(), hours_months_.data(), days_weeks_.data()};
+    auto dt = Schedule::ToCalendarTime(time);
+    auto probe = MakeProbe(dt);
+
+#ifdef ORYX_CHRON_MATCH_AVX2
+    if (HasAvx2()) {
+        MatchAvx2(columns, probe, GetSize(), bitmap.data());
+    } else {
+        MatchScalar(columns, probe, 0, GetSize(), bitmap.data());
+    }
+#else
+    MatchScalar(columns, probe, 0, GetSize(), bitmap.data());
+#endif
+
+    for (const auto& [index, masks] : calendar_) {
+        auto& word = bitmap[index / 64];
+        if ((word >> (index % 64) & 1u) && !(masks.GetMonthDays(dt.year, dt.month) >> dt.day & 1u)) {
+            word &= ~(uint64_t{1} << (index % 64));
+        }
+    }
+}
+
+void ScheduleMatcher::MatchIndices(TimePoint time, std::vector<std::size_t>& indices) const {
+    std::vector<uint64_t> bitmap;
+    Match(time, bitmap);
+
+    indices.clear();
+    for (std::size_t word = 0; word < bitmap.size(); ++word) {
+        for (auto bits = bitmap[word]; bits != 0; bits &= bits - 1) {
+            indices.push_back(word * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+        }
+    }
+}
+
+}  // namespace oryx::chron
@@ -0,0 +1,256 @@
+#include <oryx/chron/snapshot.hpp>
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+#include <oryx/chron/details/file.hpp>
+
+namespace oryx::chron {
+namespace {
+
+constexpr std::array<char, 8> kMagic{'O', 'R', 'Y', 'X', 'C', 'H', 'R', 'N'};
+// Stored as written, a file from a machine of the other byte order reads back as 0x04030201.
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+enum TaskFlags : uint8_t {
+    kValid = 1 << 0,
+    kHasMisfirePolicy = 1 << 1,
+};
+
+struct Header {
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t byte_order;
+    // Time points are stored as ticks of the clock duration, which is checked on load.
+    int64_t period_num;
+    int64_t period_den;
+    int64_t last_tick;
+    uint64_t schedule_count;
+    uint64_t task_count;
+    uint64_t strings_size;
+};
+
+struct ScheduleRecord {
+    uint64_t seconds;
+    uint64_t minutes;
+    uint64_t nth_weekdays;
+    std::array<uint64_t, 3> years;
+    uint32_t hours;
+    uint32_t days;
+    uint32_t last_day_offsets;
+    uint32_t nearest_weekdays;
+    uint16_t months;
+    uint8_t weeks;
+    uint8_t last_weekdays;
+    std::array<uint8_t, 4> padding;
+};
+
+struct TaskRecord {
+    int64_t next_schedule;
+    int64_t last_run;
+    int64_t delay;
+    int64_t tolerance;
+    uint64_t max_runs;
+    // Name, expression and time zone follow each other in the string table.
+    uint64_t strings_offset;
+    uint32_t name_size;
+    uint32_t expression_size;
+    uint32_t time_zone_size;
+    uint32_t schedule;
+    uint8_t flags;
+    uint8_t action;
+    std::array<uint8_t, 6> padding;
+};
+
+static_assert(sizeof(Header) == 64 && sizeof(ScheduleRecord) == 72 && sizeof(TaskRecord) == 72);
+static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<TaskRecord>);
+
+template <typename T>
+auto Read(const void* data) -> T {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename T>
+auto WriteRecords(int file, const T* data, std::size_t count) -> bool {
+    return details::WriteFile(file, data, sizeof(T) * count);
+}
+
+auto ToTicks(TimePoint time) -> int64_t { return static_cast<int64_t>(time.time_since_epoch().count()); }
+auto FromTicks(int64_t ticks) -> TimePoint { return TimePoint(Duration(ticks)); }
+
+}  // namespace
+
+void SnapshotWriter::Reserve(std::size_t num_tasks) { tasks_.reserve(num_tasks * sizeof(TaskRecord)); }
+
+void SnapshotWriter::Add(const SnapshotTask& task) {
+    auto [it, inserted] = schedule_index_.try_emplace(task.masks, static_cast<uint32_t>(schedules_.size()));
+    if (inserted) {
+        schedules_.push_back(task.masks);
+    }
+
+    auto policy = task.misfire_policy.value_or(MisfirePolicy{});
+    TaskRecord record{
+        .next_schedule = ToTicks(task.next_schedule),
+        .last_run = ToTicks(task.last_run),
+        .delay = static_cast<int64_t>(task.delay.count()),
+        .tolerance = static_cast<int64_t>(policy.tolerance.count()),
+        .max_runs = policy.max_runs,
+        .strings_offset = strings_.size(),
+        .name_size = static_cast<uint32_t>(task.name.size()),
+        .expression_size = static_cast<uint32_t>(task.expression.size()),
+        .time_zone_size = static_cast<uint32_t>(task.time_zone.size()),
+        .schedule = it->second,
+        .flags = static_cast<uint8_t>((task.valid ? kValid : 0) | (task.misfire_policy ? kHasMisfirePolicy : 0)),
+        .action = static_cast<uint8_t>(policy.action),
+        .padding = {},
+    };
+
+    auto offset = tasks_.size();
+    tasks_.resize(offset + sizeof(TaskRecord));
+    std::memcpy(tasks_.data() + offset, &record, sizeof(TaskRecord));
+
+    strings_.append(task.name);
+    strings_.append(task.expression);
+    strings_.append(task.time_zone);
+}
+
+auto SnapshotWriter::Write(const std::filesystem::path& path, TimePoint last_tick) const -> bool {
+    Header header{
+        .magic = kMagic,
+        .version = kVersion,
+        .byte_order = kByteOrderMark,
+        .period_num = Duration::period::num,
+        .period_den = Duration::period::den,
+        .last_tick = ToTicks(last_tick),
+        .schedule_count = schedules_.size(),
+        .task_count = tasks_.size() / sizeof(TaskRecord),
+        .strings_size = strings_.size(),
+    };
+
+    std::vector<ScheduleRecord> schedules;
+    schedules.reserve(schedules_.size());
+    for (const auto& masks : schedules_) {
+        schedules.push_back({.seconds = masks.seconds,
+                             .minutes = masks.minutes,
+                             .nth_weekdays = masks.nth_weekdays,
+                             .years = masks.years,
+                             .hours = masks.hours,
+                             .days = masks.days,
+                             .last_day_offsets = masks.last_day_offsets,
+                             .nearest_weekdays = masks.nearest_weekdays,
+                             .months = masks.months,
+                             .weeks = masks.weeks,
+                             .last_weekdays = masks.last_weekdays,
+                             .padding = {}});
+    }
+
+    auto temporary = path;
+    temporary += ".tmp";
+    auto file = details::OpenFile(temporary, true);
+    if (file < 0) {
+        return false;
+    }
+    // The data has to be on disk before the file replaces the previous snapshot, a power loss could leave a
+    // truncated snapshot behind otherwise.
+    auto ok = WriteRecords(file, &header, 1) && WriteRecords(file, schedules.data(), schedules.size()) &&
+              WriteRecords(file, tasks_.data(), tasks_.size()) &&
+              WriteRecords(file, strings_.data(), strings_.size()) && details::SyncFile(file);
+    details::CloseFile(file);
+    return ok && details::ReplaceFile(temporary, path);
+}
+
+auto Snapshot::Open(const std::filesystem::path& path) -> std::optional<Snapshot> {
+    auto file = details::MappedFile::Open(path);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    auto data = file->GetData();
+    if (data.size() < sizeof(Header)) {
+        return std::nullopt;
+    }
+
+    auto header = Read<Header>(data.data());
+    if (header.magic != kMagic || header.version != SnapshotWriter::kVersion ||
+        header.byte_order != kByteOrderMark || header.period_num != Duration::period::num ||
+        header.period_den != Duration::period::den) {
+        return std::nullopt;
+    }
+
+    // Counts are checked one by one so that none of the sizes below can overflow.
+    auto available = data.size() - sizeof(Header);
+    if (header.schedule_count > available / sizeof(ScheduleRecord)) {
+        return std::nullopt;
+    }
+    available -= header.schedule_count * sizeof(ScheduleRecord);
+    if (header.task_count > available / sizeof(TaskRecord)) {
+        return std::nullopt;
+    }
+    available -= header.task_count * sizeof(TaskRecord);
+    if (header.strings_size != available) {
+        return std::nullopt;
+    }
+
+    Snapshot snapshot(std::move(file.value()));
+    auto* begin = reinterpret_cast<const std::byte*>(snapshot.file_.GetData().data());
+    snapshot.last_tick_ = FromTicks(header.last_tick);
+    snapshot.schedules_ = begin + sizeof(Header);
+    snapshot.tasks_ = snapshot.schedules_ + header.schedule_count * sizeof(ScheduleRecord);
+    snapshot.strings_ = reinterpret_cast<const char*>(snapshot.tasks_ + header.task_count * sizeof(TaskRecord));
+    snapshot.task_count_ = header.task_count;
+
+    for (std::size_t i = 0; i < header.task_count; ++i) {
+        auto record = Read<TaskRecord>(snapshot.tasks_ + i * sizeof(TaskRecord));
+        auto strings_size = uint64_t{record.name_size} + record.expression_size + record.time_zone_size;
+        if (record.schedule >= header.schedule_count || record.strings_offset > header.strings_size ||
+            strings_size > header.strings_size - record.strings_offset ||
+            record.action > static_cast<uint8_t>(MisfireAction::Skip)) {
+            return std::nullopt;
+        }
+    }
+
+    return snapshot;
+}
+
+auto Snapshot::GetTask(std::size_t index) const -> SnapshotTask {
+    auto record = Read<TaskRecord>(tasks_ + index * sizeof(TaskRecord));
+    auto schedule = Read<ScheduleRecord>(schedules_ + record.schedule * sizeof(ScheduleRecord));
+
+    ChronMasks masks;
+    masks.seconds = schedule.seconds;
+    masks.minutes = schedule.minutes;
+    masks.hours = schedule.hours;
+    masks.days = schedule.days;
+    masks.months = schedule.months;
+    masks.weeks = schedule.weeks;
+    masks.last_weekdays = schedule.last_weekdays;
+    masks.last_day_offsets = schedule.last_day_offsets;
+    masks.nearest_weekdays = schedule.nearest_weekdays;
+    masks.nth_weekdays = schedule.nth_weekdays;
+    masks.years = schedule.years;
+
+    std::optional<MisfirePolicy> misfire_policy;
+    if (record.flags & kHasMisfirePolicy) {
+        misfire_policy = MisfirePolicy{.action = static_cast<MisfireAction>(record.action),
+                                       .max_runs = static_cast<std::size_t>(record.max_runs),
+                                       .tolerance = Duration(record.tolerance)};
+    }
+
+    const auto* strings = strings_ + record.strings_offset;
+    return SnapshotTask{
+        .name = {strings, record.name_size},
+        .expression = {strings + record.name_size, record.expression_size},
+        .time_zone = {strings + record.name_size + record.expression_size, record.time_zone_size},
+        .masks = masks,
+        .next_schedule = FromTicks(record.next_schedule),
+        .last_run = FromTicks(record.last_run),
+        .delay = Duration(record.delay),
+        .valid = (record.flags & kValid) != 0,
+        .misfire_policy = misfire_policy,
+    };
+}
+
+}  // namespace oryx::chron
@@ -1,5 +1,6 @@
 #include <oryx/chron/task.hpp>
 
+#include <algorithm>
 #include <format>
 
 #include <oryx/chron/common.hpp>
@@ -7,11 +8,65 @@
 using namespace std::chrono;
 
 namespace oryx::chron {
+namespace {
 
-Task::Task(std::string name, Schedule schedule, TaskFn task)
+using Period = RandomizationTemplate::Period;
+
+// Consecutive numbers for consecutive periods of the kind `kind`.
+auto GetPeriodIndex(Period kind, const Schedule::Cursor &cursor) -> int64_t {
+    auto days = cursor.date.GetDays();
+    const auto &date = cursor.date.GetDate();
+    switch (kind) {
+        case Period::Minute:
+            return (days * 24 + cursor.hour) * 60 + cursor.minute;
+        case Period::Hour:
+            return days * 24 + cursor.hour;
+        case Period::Day:
+            return days;
+        case Period::Week:
+            // Weeks start on Sunday and are numbered by the day they start on.
+            return days - date.weekday;
+        case Period::Month:
+            return int64_t{date.year} * 12 + date.month - 1;
+        case Period::Year:
+            return date.year;
+    }
+    return days;
+}
+
+auto GetPeriodStart(Period kind, const Schedule::Cursor &cursor) -> TimePoint {
+    auto days = cursor.date.GetDays();
+    const auto &date = cursor.date.GetDate();
+    auto day = sys_days(std::chrono::days(days));
+    switch (kind) {
+        case Period::Minute:
+            return day + hours(cursor.hour) + minutes(cursor.minute);
+        case Period::Hour:
+            return day + hours(cursor.hour);
+        case Period::Day:
+            return day;
+        case Period::Week:
+            return day - std::chrono::days(date.weekday);
+        case Period::Month:
+            return sys_days(std::chrono::days(details::DaysFromCivil(date.year, date.month, 1)));
+        case Period::Year:
+            return sys_days(std::chrono::days(details::DaysFromCivil(date.year, 1, 1)));
+    }
+    return day;
+}
+
+}  // namespace
+
+Task::Task(std::string name,
+           Schedule schedule,
+           TaskFn task,
+           std::shared_ptr<const TimeZone> time_zone,
+           std::string expression)
     : name_(std::move(name)),
       schedule_(std::move(schedule)),
       task_(std::move(task)),
+      time_zone_(std::move(time_zone)),
+      expression_(std::move(expression)),
       next_schedule_(),
       delay_(std::chrono::seconds(-1)),
       last_run_(std::numeric_limits<TimePoint>::min()),
@@ -19,19 +74,38 @@ Task::Task(std::string name, Schedule schedule, TaskFn task)
 
 void Task::Execute(TimePoint now) {
     // Next Schedule is still the current schedule, calculate delay (actual execution - planned execution)
-    delay_ = now - next_schedule_;
+    delay_ = now - GetDueTime();
 
     last_run_ = now;
-    task_(TaskInfo(name_, delay_));
+    task_(TaskInfo(name_, delay_, next_schedule_));
 }
 
-auto Task::CalculateNext(TimePoint from) -> bool {
-    auto time_point = schedule_.CalculateFrom(from);
+auto Task::CalculateNext(TimePoint from, seconds clock_offset) -> bool {
+    // Dispersed occurrences are due when the scheduler clock reaches their dispersed time.
+    from -= dispersion_;
+
+    // Search on the wall clock of the task and bring the result back onto the scheduler timeline.
+    auto utc = from - clock_offset;
+    auto local = time_zone_ ? time_zone_->ToLocal(utc) : from;
+
+    // Right after an execution the search continues one second past the previous occurrence, anything else
+    // (first calculation, clock changes, late ticks) starts over from the given time.
+    if (cursor_ && valid_ && floor<seconds>(local) == cursor_->ToTimePoint() + 1s) {
+        cursor_->second++;
+    } else {
+        cursor_.emplace(local);
+    }
 
     // In case the calculation fails, the task will no longer expire.
-    valid_ = time_point.has_value();
+    valid_ = schedule_.Advance(cursor_.value());
+    if (valid_ && redraw_) [[unlikely]] {
+        RedrawIfDue(local);
+    }
     if (valid_) {
-        next_schedule_ = time_point.value();
+        next_schedule_ = cursor_->ToTimePoint();
+        if (time_zone_) {
+            next_schedule_ = time_zone_->ToUtc(next_schedule_, floor<seconds>(utc)) + clock_offset;
+        }
 
         // Make sure that the task is allowed to run.
         last_run_ = next_schedule_ - 1s;
@@ -40,19 +114,107 @@ auto Task::CalculateNext(TimePoint from) -> bool {
     return valid_;
 }
 
+auto Task::SetRandomization(std::shared_ptr<const RandomizationTemplate> pattern,
+                            uint64_t key,
+                            Occupancy *occupancy) -> bool {
+    redraw_ = std::make_shared<const Redraw>(std::move(pattern), key);
+    occupancy_ = occupancy;
+    drawn_period_.reset();
+    cursor_.reset();
+    // Stands in until the first calculation draws for the period it starts in.
+    return DrawSchedule(0);
+}
+
+void Task::ResumeRandomization(std::shared_ptr<const RandomizationTemplate> pattern,
+                               uint64_t key,
+                               Occupancy *occupancy) {
+    auto kind = pattern->GetPeriod();
+    redraw_ = std::make_shared<const Redraw>(std::move(pattern), key);
+    occupancy_ = occupancy;
+    drawn_period_.reset();
+    // Randomized tasks run on the scheduler clock, their occurrences are local times already.
+    if (valid_) drawn_period_ = GetPeriodIndex(kind, Schedule::Cursor(next_schedule_));
+}
+
+auto Task::DrawSchedule(int64_t period) -> bool {
+    auto state = redraw_->key ^ static_cast<uint64_t>(period);
+    Randomization randomization(details::SplitMix64(state));
+    for (int i = 0; i < kMaxDraws; ++i) {
+        auto masks = occupancy_ ? randomization.Place(*redraw_->pattern, *occupancy_)
+                                : randomization.Generate(*redraw_->pattern);
+        if (masks) {
+            schedule_ = Schedule(*masks);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Task::RedrawIfDue(TimePoint local) {
+    auto kind = redraw_->pattern->GetPeriod();
+    auto from = floor<seconds>(local);
+    // Every occurrence comes from the draw of its own period. The first calculation starts in the period `local` is
+    // in, later ones in the period of the occurrence found by the previous draw.
+    auto at = drawn_period_ ? cursor_.value() : Schedule::Cursor(from);
+    for (int i = 0; i < kMaxPeriods; ++i) {
+        auto period = GetPeriodIndex(kind, at);
+        if (period == drawn_period_) {
+            return;
+        }
+
+        // The period gets its own draw searched from its start, or from `local` within it. A failed draw keeps the
+        // previous schedule. The previous draw leaves the occupancy first, so that its slots count as free.
+        drawn_period_ = period;
+        if (occupancy_) occupancy_->Remove(schedule_.GetMasks());
+        if (!DrawSchedule(period)) {
+            if (occupancy_) occupancy_->Add(schedule_.GetMasks());
+            return;
+        }
+        cursor_.emplace(std::max<TimePoint>(GetPeriodStart(kind, at), from));
+        valid_ = schedule_.Advance(cursor_.value());
+        if (!valid_) {
+            return;
+        }
+        at = cursor_.value();
+    }
+}
+
+void Task::Restore(TimePoint next_schedule, TimePoint last_run, Duration delay, bool valid) {
+    next_schedule_ = next_schedule;
+    last_run_ = last_run;
+    delay_ = delay;
+    valid_ = valid;
+    // The next search starts over, no calendar position is known for the restored occurrence.
+    cursor_.reset();
+}
+
+auto Task::PeekNext(TimePoint from, seconds clock_offset) const -> std::optional<TimePoint> {
+    from -= dispersion_;
+    auto utc = from - clock_offset;
+    auto next = schedule_.CalculateFrom(time_zone_ ? time_zone_->ToLocal(utc) : from);
+    if (!next) [[unlikely]] {
+        return std::nullopt;
+    }
+    if (time_zone_) {
+        *next = time_zone_->ToUtc(*next, floor<seconds>(utc)) + clock_offset;
+    }
+    return *next + dispersion_;
+}
+
 auto Task::TimeUntilExpiry(TimePoint now) const -> Duration {
     // Explicitly return 0s instead of a possibly negative duration when it has expired.
-    if (now >= next_schedule_) {
+    auto due = GetDueTime();
+    if (now >= due) {
         return 0s;
     }
-    return next_schedule_ - now;
+    return due - now;
 }
 
 auto Task::IsExpired(TimePoint now) const -> bool { return valid_ && now >= last_run_ && TimeUntilExpiry(now) == 0s; }
 
-auto Task::GetStatus(TimePoint now) const -> std::string {
-    auto dt = Schedule::ToCalendarTime(next_schedule_);
-    auto expires_in = duration_cast<milliseconds>(TimeUntilExpiry(now));
+auto Task::GetStatus(TimePoint now, TimePoint due) const -> std::string {
+    auto dt = Schedule::ToCalendarTime(due);
+    auto expires_in = duration_cast<milliseconds>(now >= due ? Duration::zero() : due - now);
     return std::format("'{}' expires in => {}-{}-{} {}:{}:{}", name_, expires_in, dt.year, dt.month, dt.day, dt.hour,
                        dt.min, dt.sec);
 }
@@ -0,0 +1,79 @@
+#include <oryx/chron/time_zone.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std::chrono;
+
+namespace oryx::chron {
+namespace {
+
+// Offsets never change more than once within this margin, so an instant this far away from both ends of a
+// cached period can not be part of a skipped or repeated wall time.
+constexpr auto kTransitionMargin = hours{24};
+
+auto ToTimePoint(sys_seconds time) -> TimePoint {
+    static const auto kMin = ceil<seconds>(TimePoint::min());
+    static const auto kMax = floor<seconds>(TimePoint::max());
+    return TimePoint(std::clamp(time, kMin, kMax));
+}
+
+}  // namespace
+
+TimeZone::TimeZone(const time_zone *zone)
+    : zone_(zone) {}
+
+auto TimeZone::Locate(std::string_view name) -> std::optional<TimeZone> {
+    const time_zone *zone{};
+
+    try {
+        zone = locate_zone(name);
+    } catch (std::runtime_error &) {
+        return std::nullopt;
+    }
+
+    if (!zone) return std::nullopt;
+    return TimeZone(zone);
+}
+
+auto TimeZone::GetName() const -> std::string_view { return zone_->name(); }
+
+void TimeZone::Resolve(TimePoint utc) {
+    if (utc >= begin_ && utc < end_) [[likely]] {
+        return;
+    }
+
+    auto info = zone_->get_info(utc);
+    begin_ = ToTimePoint(info.begin);
+    end_ = ToTimePoint(info.end);
+    offset_ = info.offset;
+}
+
+auto TimeZone::ToLocal(TimePoint utc) const -> TimePoint {
+    if (utc >= begin_ && utc < end_) [[likely]] {
+        return utc + offset_;
+    }
+    return utc + zone_->get_info(utc).offset;
+}
+
+auto TimeZone::ToUtc(TimePoint local, TimePoint not_before) const -> TimePoint {
+    auto candidate = local - offset_;
+    if (candidate >= begin_ + kTransitionMargin && candidate < end_ - kTransitionMargin) [[likely]] {
+        return candidate;
+    }
+
+    auto info = zone_->get_info(local_time<Duration>(local.time_since_epoch()));
+    switch (info.result) {
+        case local_info::nonexistent:
+            return ToTimePoint(info.first.end);
+        case local_info::ambiguous:
+            if (local - info.first.offset >= not_before) {
+                return local - info.first.offset;
+            }
+            return local - info.second.offset;
+        default:
+            return local - info.first.offset;
+    }
+}
+
+}  // namespace oryx::chron
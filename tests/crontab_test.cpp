@@ -0,0 +1,164 @@
+#include "doctest.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <oryx/chron/crontab.hpp>
+#include <oryx/chron/crontab_watcher.hpp>
+#include <oryx/chron/scheduler.hpp>
+
+using namespace oryx::chron;
+
+namespace {
+
+struct ManualClock {
+    auto Now() const -> TimePoint { return now; }
+    auto UtcOffset(TimePoint) const -> std::chrono::seconds { return std::chrono::seconds{0}; }
+
+    TimePoint now{};
+};
+
+auto WriteFile(const std::string& name, std::string_view content) -> std::filesystem::path {
+    auto path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+    return path;
+}
+
+}  // namespace
+
+TEST_CASE("Reading crontab files") {
+    GIVEN("A file with tasks, comments and blank lines") {
+        static constexpr std::string_view kContent =
+            "# nightly jobs\n"
+            "backup 0 0 2 * * ?\r\n"
+            "\n"
+            "  report\t0 30 6 ? * MON-FRI  \n"
+            "lonely\n"
+            "broken 0 0 25 * * ?";
+        auto path = WriteFile("chron_crontab_test.txt", kContent);
+
+        auto crontab = Crontab::Open(path);
+        REQUIRE(crontab);
+        REQUIRE_EQ(crontab->GetData(), kContent);
+
+        std::vector<Crontab::Entry> entries;
+        crontab->ForEach([&entries](const Crontab::Entry& entry) { entries.push_back(entry); });
+
+        REQUIRE_EQ(entries.size(), 4);
+        REQUIRE_EQ(entries[0].name, "backup");
+        REQUIRE_EQ(entries[0].expression, "0 0 2 * * ?");
+        REQUIRE_EQ(entries[0].line, 2);
+        REQUIRE_EQ(entries[0].offset, kContent.find("backup"));
+        REQUIRE_EQ(entries[1].name, "report");
+        REQUIRE_EQ(entries[1].expression, "0 30 6 ? * MON-FRI");
+        REQUIRE_EQ(entries[1].line, 4);
+        REQUIRE_EQ(entries[2].name, "lonely");
+        REQUIRE(entries[2].expression.empty());
+        REQUIRE_EQ(entries[3].expression, "0 0 25 * * ?");
+        REQUIRE_EQ(entries[3].offset, kContent.find("broken"));
+
+        WHEN("Adding the file to a scheduler") {
+            Scheduler scheduler;
+            auto errors = scheduler.AddCrontab(crontab.value(), [](auto) {});
+
+            THEN("Valid entries are added and the others reported") {
+                REQUIRE_EQ(scheduler.GetNumTasks(), 2);
+                REQUIRE_EQ(errors.size(), 2);
+                REQUIRE_EQ(errors[0].line, 5);
+                REQUIRE_EQ(errors[0].offset, kContent.find("lonely"));
+                REQUIRE_EQ(errors[0].message, "missing expression");
+                REQUIRE_EQ(errors[1].line, 6);
+                REQUIRE_EQ(errors[1].message, "invalid expression '0 0 25 * * ?'");
+            }
+        }
+
+        auto moved = std::move(crontab.value());
+        REQUIRE_EQ(moved.GetData(), kContent);
+        REQUIRE(crontab->GetData().empty());
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("An empty file") {
+        auto path = WriteFile("chron_crontab_empty.txt", "");
+        auto crontab = Crontab::Open(path);
+        REQUIRE(crontab);
+        REQUIRE(crontab->GetData().empty());
+        std::filesystem::remove(path);
+    }
+
+    GIVEN("A file that does not exist") {
+        REQUIRE_FALSE(Crontab::Open(std::filesystem::temp_directory_path() / "chron_crontab_missing.txt"));
+    }
+}
+
+TEST_CASE("Reloading a watched crontab") {
+    auto path = WriteFile("chron_crontab_watched.txt",
+                          "keep 0 0 * * * ?\n"
+                          "change 0 30 * * * ?\n"
+                          "remove 0 15 * * * ?\n");
+
+    Scheduler<ManualClock> scheduler;
+    auto start = std::chrono::sys_days{std::chrono::year{2024} / 1 / 1};
+    scheduler.GetClock().now = start;
+    REQUIRE(scheduler.AddSchedule("other", "0 45 * * * ?", [](auto) {}));
+
+    std::vector<std::string> runs;
+    CrontabWatcher watcher(scheduler, path, [&runs](TaskInfo info) { runs.emplace_back(info.name); });
+    REQUIRE(watcher.Reload().empty());
+    REQUIRE_EQ(scheduler.GetNumTasks(), 4);
+
+    REQUIRE_EQ(scheduler.Tick(), 1);
+    REQUIRE_FALSE(watcher.Poll());
+
+    GIVEN("A new version of the file") {
+        WriteFile("chron_crontab_watched.txt",
+                  "keep 0 0 * * * ?\n"
+                  "change 0 20 * * * ?\n"
+                  "add 0 10 * * * ?\n"
+                  "invalid 0 0 25 * * ?\n");
+
+        WHEN("Polling for changes") {
+            auto errors = watcher.Poll();
+            REQUIRE(errors);
+            REQUIRE_EQ(errors->size(), 1);
+            REQUIRE_EQ(errors->front().line, 4);
+
+            THEN("Only the differences are applied") {
+                REQUIRE_EQ(scheduler.GetNumTasks(), 4);
+                REQUIRE_FALSE(watcher.Poll());
+
+                for (auto minute : {10, 20, 45, 60}) {
+                    scheduler.GetClock().now = start + std::chrono::minutes{minute};
+                    scheduler.Tick();
+                }
+                REQUIRE_EQ(runs, std::vector<std::string>{"keep", "add", "change", "keep"});
+            }
+        }
+        AND_WHEN("An invalid expression replaces a valid one") {
+            REQUIRE(watcher.Reload().size() == 1);
+            WriteFile("chron_crontab_watched.txt", "keep 0 0 25 * * ?\n");
+            auto errors = watcher.Reload();
+            REQUIRE_EQ(errors.size(), 1);
+
+            THEN("The previous task is kept") {
+                REQUIRE_EQ(scheduler.GetNumTasks(), 2);
+                scheduler.GetClock().now = start + std::chrono::hours{1};
+                REQUIRE_EQ(scheduler.Tick(), 2);
+                REQUIRE_EQ(runs.back(), "keep");
+            }
+        }
+    }
+
+    GIVEN("The file is gone") {
+        std::filesystem::remove(path);
+        auto errors = watcher.Poll();
+        REQUIRE(errors);
+        REQUIRE_EQ(errors->size(), 1);
+        THEN("All tasks are kept") { REQUIRE_EQ(scheduler.GetNumTasks(), 4); }
+    }
+
+    std::filesystem::remove(path);
+}
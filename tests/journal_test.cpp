@@ -0,0 +1,209 @@
+#include "doctest.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <oryx/chron/journal.hpp>
+#include <oryx/chron/scheduler.hpp>
+
+using namespace oryx::chron;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct ManualClock {
+    auto Now() const -> TimePoint { return now; }
+    auto UtcOffset(TimePoint) const -> std::chrono::seconds { return std::chrono::seconds{0}; }
+
+    TimePoint now{};
+};
+
+auto MakeTime(int hour, int minute, int second) -> TimePoint {
+    return std::chrono::sys_days{std::chrono::year{2024} / 3 / 1} + std::chrono::hours{hour} +
+           std::chrono::minutes{minute} + std::chrono::seconds{second};
+}
+
+}  // namespace
+
+TEST_CASE("Journal") {
+    auto path = std::filesystem::temp_directory_path() / "chron_journal_test.log";
+    std::filesystem::remove(path);
+
+    GIVEN("A journal with a few runs") {
+        {
+            auto journal = Journal::Open(path);
+            REQUIRE(journal);
+            journal->Append("a", MakeTime(12, 0, 0), MakeTime(12, 0, 1));
+            journal->Append("b", MakeTime(12, 0, 0), MakeTime(12, 0, 0));
+            journal->Append("a", MakeTime(12, 1, 0), MakeTime(12, 1, 0));
+            REQUIRE(journal->Flush());
+            journal->Append("b", MakeTime(12, 5, 0), MakeTime(12, 5, 0));
+        }
+
+        WHEN("Opening it again") {
+            auto journal = Journal::Open(path);
+            REQUIRE(journal);
+
+            THEN("The last run of every task is known, including the ones written on close") {
+                REQUIRE_EQ(journal->GetNumTasks(), 2);
+                REQUIRE_EQ(journal->GetLastRun("a")->scheduled, MakeTime(12, 1, 0));
+                REQUIRE_EQ(journal->GetLastRun("b")->fired, MakeTime(12, 5, 0));
+                REQUIRE_FALSE(journal->GetLastRun("c"));
+            }
+        }
+
+        WHEN("The last run was only partly written") {
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+            auto journal = Journal::Open(path);
+            REQUIRE(journal);
+
+            THEN("It is dropped") {
+                REQUIRE_EQ(journal->GetLastRun("b")->scheduled, MakeTime(12, 0, 0));
+                journal->Append("c", MakeTime(13, 0, 0), MakeTime(13, 0, 0));
+                journal.reset();
+
+                auto reopened = Journal::Open(path);
+                REQUIRE_EQ(reopened->GetNumTasks(), 3);
+                REQUIRE_EQ(reopened->GetLastRun("c")->scheduled, MakeTime(13, 0, 0));
+            }
+        }
+    }
+
+    GIVEN("A journal with many runs of the same tasks") {
+        auto size = std::size_t{};
+        {
+            auto journal = Journal::Open(path);
+            for (std::size_t i = 0; i < Journal::kMinCompactionSize + 1000; ++i) {
+                journal->Append(i % 2 == 0 ? "even" : "odd", MakeTime(0, 0, 0) + std::chrono::seconds(i),
+                                MakeTime(0, 0, 0) + std::chrono::seconds(i));
+                if (i % 1000 == 999) journal->Flush();
+            }
+        }
+        size = std::filesystem::file_size(path);
+
+        THEN("It is compacted to the last runs") {
+            // Runs written while the compaction was busy are kept as they are.
+            REQUIRE_LT(size, 1000 * sizeof(Journal::Run));
+            auto journal = Journal::Open(path);
+            REQUIRE_EQ(journal->GetNumTasks(), 2);
+            REQUIRE_EQ(journal->GetLastRun("odd")->scheduled,
+                       MakeTime(0, 0, 0) + std::chrono::seconds(Journal::kMinCompactionSize + 999));
+        }
+    }
+
+    GIVEN("A file that is not a journal") {
+        std::ofstream(path, std::ios::binary) << std::string(64, 'x');
+        THEN("It is left alone") {
+            REQUIRE_FALSE(Journal::Open(path));
+            REQUIRE_EQ(std::filesystem::file_size(path), 64);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Restarting with a journal") {
+    auto path = std::filesystem::temp_directory_path() / "chron_journal_scheduler_test.log";
+    std::filesystem::remove(path);
+
+    std::vector<TaskInfo> runs;
+    auto record = [&runs](TaskInfo info) { runs.push_back(info); };
+
+    GIVEN("A scheduler that ran a task before stopping") {
+        {
+            Scheduler<ManualClock> scheduler;
+            scheduler.GetClock().now = MakeTime(12, 0, 30);
+            REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+            REQUIRE(scheduler.OpenJournal(path));
+            REQUIRE_EQ(scheduler.Tick(MakeTime(12, 1, 0)), 1);
+        }
+
+        WHEN("It restarts within the same second") {
+            Scheduler<ManualClock> scheduler;
+            scheduler.GetClock().now = MakeTime(12, 1, 0);
+            REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+            REQUIRE(scheduler.OpenJournal(path));
+
+            THEN("The run is not repeated") {
+                REQUIRE_EQ(scheduler.Tick(MakeTime(12, 1, 0)), 0);
+                REQUIRE_EQ(scheduler.Tick(MakeTime(12, 2, 0)), 1);
+            }
+        }
+
+        WHEN("It restarts a few minutes later") {
+            Scheduler<ManualClock> scheduler;
+            scheduler.GetClock().now = MakeTime(12, 5, 30);
+            REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+            REQUIRE(scheduler.OpenJournal(path));
+
+            THEN("The missed runs are handled by the misfire policy") {
+                runs.clear();
+                REQUIRE_EQ(scheduler.Tick(MakeTime(12, 5, 30)), 1);
+                REQUIRE_EQ(runs[0].scheduled, MakeTime(12, 2, 0));
+                REQUIRE_EQ(scheduler.Tick(MakeTime(12, 6, 0)), 1);
+            }
+        }
+    }
+
+    GIVEN("A scheduler that ran a task late before stopping") {
+        {
+            Scheduler<ManualClock> scheduler;
+            scheduler.GetClock().now = MakeTime(12, 0, 30);
+            REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+            REQUIRE(scheduler.OpenJournal(path));
+            REQUIRE_EQ(scheduler.Tick(MakeTime(12, 1, 5)), 1);
+        }
+
+        Scheduler<ManualClock> scheduler;
+        scheduler.GetClock().now = MakeTime(12, 1, 30);
+        REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+        REQUIRE(scheduler.OpenJournal(path));
+
+        THEN("The last run is the one in the journal") {
+            auto snapshot_path = std::filesystem::temp_directory_path() / "chron_journal_snapshot_test.bin";
+            REQUIRE(scheduler.SaveSnapshot(snapshot_path));
+            auto snapshot = Snapshot::Open(snapshot_path);
+            REQUIRE(snapshot);
+            REQUIRE_EQ(snapshot->GetSize(), 1);
+            snapshot->ForEach([](const SnapshotTask& task) {
+                REQUIRE_EQ(task.next_schedule, MakeTime(12, 2, 0));
+                REQUIRE_EQ(task.last_run, MakeTime(12, 1, 5));
+                REQUIRE_EQ(task.delay, 5s);
+            });
+            std::filesystem::remove(snapshot_path);
+        }
+    }
+
+    GIVEN("Tasks that share a name") {
+        Scheduler<ManualClock> scheduler;
+        scheduler.GetClock().now = MakeTime(12, 0, 30);
+        REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+        REQUIRE(scheduler.AddSchedule("minutely", "30 * * * * ?", record));
+
+        THEN("The journal is not opened") {
+            REQUIRE_FALSE(scheduler.OpenJournal(path));
+            scheduler.RemoveSchedule("minutely");
+            REQUIRE(scheduler.OpenJournal(path));
+        }
+        THEN("No task with a taken name is added while it is open") {
+            scheduler.RemoveSchedule("minutely");
+            REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+            REQUIRE(scheduler.OpenJournal(path));
+            REQUIRE_FALSE(scheduler.AddSchedule("minutely", "30 * * * * ?", record));
+            REQUIRE_FALSE(scheduler.AddRandomizedSchedule("minutely", "R(0-59) * * * * ?", record));
+            scheduler.AddScheduleBatch([&record](auto add_schedule) {
+                add_schedule("minutely", "15 * * * * ?", record);
+                add_schedule("hourly", "0 0 * * * ?", record);
+                add_schedule("hourly", "0 30 * * * ?", record);
+            });
+            REQUIRE_EQ(scheduler.GetNumTasks(), 2);
+
+            scheduler.CloseJournal();
+            REQUIRE(scheduler.AddSchedule("minutely", "30 * * * * ?", record));
+        }
+    }
+
+    std::filesystem::remove(path);
+}
@@ -1,11 +1,18 @@
 #include "doctest.hpp"
 
 #include <algorithm>
+#include <array>
+#include <format>
+#include <functional>
 #include <ranges>
+#include <set>
+#include <utility>
 
 #include <oryx/chron/scheduler.hpp>
 #include <oryx/chron/parser.hpp>
 #include <oryx/chron/details/any_of.hpp>
+#include <oryx/chron/details/in_range.hpp>
+#include <oryx/chron/details/to_underlying.hpp>
 
 using namespace oryx::chron;
 using namespace std::chrono;
@@ -218,4 +225,195 @@ TEST_CASE("CachedParser does not cache on invalid schedule") {
     REQUIRE_FALSE(data.has_value());
     REQUIRE_FALSE(parser.Contains(kExpr));
     REQUIRE_EQ(parser.GetSize(), 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Canonical form") {
+    GIVEN("Different spellings of the same schedule") {
+        auto a = kParseExpression("0 0 * * * ?");
+        auto b = kParseExpression("0  0 0-23 * JAN-DEC ?");
+        auto c = kParseExpression("0 0 */1 ? * *");
+        REQUIRE(a);
+        REQUIRE(b);
+        REQUIRE(c);
+
+        THEN("They are equal, hash the same and share a canonical form") {
+            REQUIRE_EQ(a.value(), b.value());
+            REQUIRE_EQ(a.value(), c.value());
+            REQUIRE_EQ(std::hash<ChronData>{}(a.value()), std::hash<ChronData>{}(c.value()));
+            REQUIRE_EQ(a->ToCanonicalString(), "0 0 * * * ?");
+            REQUIRE_EQ(c->ToCanonicalString(), "0 0 * * * ?");
+            REQUIRE_NE(a.value(), kParseExpression("0 0 * * * MON").value());
+        }
+    }
+
+    GIVEN("Various expressions") {
+        static constexpr std::pair<std::string_view, std::string_view> kExpressions[] = {
+            {"0 0 12 ? * MON-FRI", "0 0 12 ? * 1-5"},
+            {"*/15 0 0 1,15 JAN,JUL ?", "0/15 0 0 1,15 1,7 ?"},
+            {"0 5-7,9 * * * ?", "0 5-7,9 * * * ?"},
+            {"0 10,20 3/7 * * ?", "0 10,20 3/7 * * ?"},
+            {"0 0 22-2 * * ?", "0 0 0-2,22-23 * * ?"},
+            {"5,10,15 0 0 31 * ?", "5,10,15 0 0 31 * ?"},
+            {"0 0 0 ? * SUN,SAT", "0 0 0 ? * 0,6"},
+            {"0 0 18 ? 3,6,9,12 FRIL", "0 0 18 ? 3/3 5L"},
+            {"0 0 0 L-2,15W,LW * ?", "0 0 0 L-2,LW,15W * ?"},
+            {"0 0 0 1-5,L * ?", "0 0 0 1-5,L * ?"},
+            {"0 0 9 ? * MON#2,MON#1,L", "0 0 9 ? * 6,1#1,1#2"},
+            {"0 0 0 1 1 ? 2030,2032-2034", "0 0 0 1 1 ? 2030,2032-2034"},
+            {"0 0 0 1 1 ? *", "0 0 0 1 1 ?"},
+            {"0 0 0 L * ? 2024/4", "0 0 0 L * ? 2024/4"},
+        };
+
+        THEN("The canonical form reads back to the same schedule") {
+            for (auto [expression, canonical] : kExpressions) {
+                CAPTURE(expression);
+                auto data = kParseExpression(expression);
+                REQUIRE(data);
+                REQUIRE_EQ(data->ToCanonicalString(), canonical);
+                REQUIRE_EQ(kParseExpression(canonical), data);
+            }
+        }
+    }
+}
+
+TEST_CASE("Quartz style fields") {
+    GIVEN("Valid entries") {
+        auto data = kParseExpression("0 0 0 L,L-3,10W,LW * ?");
+        REQUIRE(data);
+        REQUIRE(data->days.empty());
+        REQUIRE_EQ(data->last_day_offsets, std::set<uint8_t>{0, 3});
+        REQUIRE_EQ(data->nearest_weekdays, std::set{MonthDays{10}});
+        REQUIRE(data->last_weekday);
+
+        data = kParseExpression("0 0 0 ? * 5L,MON#3 2024-2026");
+        REQUIRE(data);
+        REQUIRE(data->weeks.empty());
+        REQUIRE_EQ(data->last_weekdays, std::set{Weekdays::Friday});
+        REQUIRE_EQ(data->nth_weekdays.size(), 1);
+        REQUIRE_EQ(data->nth_weekdays.begin()->first, Weekdays::Monday);
+        REQUIRE_EQ(data->nth_weekdays.begin()->second, 3);
+        REQUIRE_EQ(data->years.size(), 3);
+
+        REQUIRE(kParseExpression("0 0 0 * * ? 1970-2099")->years.empty());
+        REQUIRE(kParseExpression("  0 0 0 L * ?  2099  "));
+    }
+
+    GIVEN("Invalid entries") {
+        for (auto expression : {"0 0 0 L-31 * ?", "0 0 0 0W * ?", "0 0 0 32W * ?", "0 0 0 ? * 7L", "0 0 0 ? * 1#0",
+                                "0 0 0 ? * 1#6", "0 0 0 ? * 7#1", "0 0 0 L * 5L", "0 0 0 ? * LW", "0 0 0 * * ? 1969",
+                                "0 0 0 * * ? 2100", "0 0 0 * * ? 2030 2031", "0 0 0 W * ?", "0 0 0 L- * ?"}) {
+            CAPTURE(expression);
+            REQUIRE_FALSE(kParseExpression(expression));
+        }
+    }
+}
+
+TEST_CASE("CachedParser shares equal schedules") {
+    CachedExpressionParser parser;
+
+    REQUIRE(parser("0 0 * * * ?"));
+    REQUIRE(parser.Contains(" 0\t0 * *  * ?"));
+    REQUIRE(parser("0 0 */1 * * ?"));
+    REQUIRE(parser("0 0 0-23 * * ?"));
+    REQUIRE_EQ(parser.GetSize(), 3);
+    REQUIRE_EQ(parser.GetNumSchedules(), 1);
+
+    REQUIRE_EQ(parser("0 0 12 * * ?")->ToCanonicalString(), "0 0 12 * * ?");
+    REQUIRE_EQ(parser.GetSize(), 4);
+    REQUIRE_EQ(parser.GetNumSchedules(), 2);
+
+    // Blanks only separate fields, they are not ignored within the expression.
+    REQUIRE_FALSE(parser.Contains("0 0 1 2 * * ?"));
+    REQUIRE_FALSE(parser.Contains("0 0 12 * * ? *"));
+}
+
+TEST_CASE("Hashed fields") {
+    GIVEN("The same key") {
+        auto key = MakeHashKey("backup");
+        auto data = kParseExpression("H H H(2-5) ? * H", key);
+        REQUIRE(data);
+
+        THEN("Every field gets one value in its range, the same on every parse") {
+            REQUIRE_EQ(data->seconds.size(), 1);
+            REQUIRE_EQ(data->minutes.size(), 1);
+            REQUIRE_EQ(data->hours.size(), 1);
+            REQUIRE(details::InRange<int>(details::to_underlying(*data->hours.begin()), 2, 5));
+            REQUIRE_EQ(data->weeks.size(), 1);
+            REQUIRE_EQ(kParseExpression("H H H(2-5) ? * H", key), data);
+            REQUIRE_EQ(MakeHashKey("backup"), key);
+            REQUIRE_NE(MakeHashKey("backup", 1), key);
+        }
+    }
+
+    GIVEN("Steps") {
+        auto data = kParseExpression("0 H/15 H(8-17)/3 * * ?", MakeHashKey("report"));
+        REQUIRE(data);
+
+        THEN("There is one value in each interval") {
+            REQUIRE_EQ(data->minutes.size(), 4);
+            auto first = details::to_underlying(*data->minutes.begin());
+            REQUIRE_LT(first, 15);
+            for (auto minute : data->minutes) REQUIRE_EQ((details::to_underlying(minute) - first) % 15, 0);
+            REQUIRE_GE(data->hours.size(), 3);
+            REQUIRE(std::ranges::all_of(data->hours, [](Hours h) { return details::InRange(h, Hours{8}, Hours{17}); }));
+        }
+    }
+
+    GIVEN("Many task names") {
+        std::array<int, 60> minutes{};
+        for (auto i = 0; i < 6000; ++i) {
+            auto data = kParseExpression("0 H * * * ?", MakeHashKey(std::format("job-{}", i)));
+            ++minutes[details::to_underlying(*data->minutes.begin())];
+        }
+
+        THEN("They are spread over the whole field") {
+            REQUIRE_GT(std::ranges::min(minutes), 50);
+            REQUIRE_LT(std::ranges::max(minutes), 150);
+        }
+    }
+
+    GIVEN("Days of month") {
+        THEN("H stays within the days every month has") {
+            for (auto i = 0; i < 1000; ++i) {
+                auto data = kParseExpression("0 0 0 H * ?", static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15);
+                REQUIRE(data);
+                REQUIRE_LE(details::to_underlying(*data->days.begin()), 28);
+            }
+        }
+
+        THEN("Ranges must end within the days every month has") {
+            for (auto i = 0; i < 100; ++i) {
+                auto key = static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15;
+                auto data = kParseExpression("0 0 0 H(20-28) * ?", key);
+                REQUIRE(data);
+                REQUIRE_GE(details::to_underlying(*data->days.begin()), 20);
+                REQUIRE_FALSE(kParseExpression("0 0 0 H(1-31) * ?", key));
+                REQUIRE_FALSE(kParseExpression("0 0 0 H(1-29)/7 * ?", key));
+            }
+        }
+    }
+
+    GIVEN("Invalid entries") {
+        for (auto expression : {"0 H(5-1) * * * ?", "0 H(0-60) * * * ?", "0 H/0 * * * ?", "0 Hx * * * ?"}) {
+            CAPTURE(expression);
+            REQUIRE_FALSE(kParseExpression(expression, 1));
+        }
+    }
+
+    GIVEN("A cached parser") {
+        CachedExpressionParser parser;
+
+        THEN("Expressions with H fields are parsed for every key without being cached") {
+            REQUIRE_EQ(parser("0 H * * * ?", MakeHashKey("a")), kParseExpression("0 H * * * ?", MakeHashKey("a")));
+            REQUIRE_EQ(parser("0 H * * * ?", MakeHashKey("b")), kParseExpression("0 H * * * ?", MakeHashKey("b")));
+            REQUIRE_EQ(parser.GetSize(), 0);
+        }
+        THEN("Names that contain an H are still cached") {
+            REQUIRE(parser("0 0 9 ? * THU", MakeHashKey("a")));
+            REQUIRE(parser("0 0 9 ? * THU", MakeHashKey("b")));
+            REQUIRE(parser("0 0 9 ? MAR THU", MakeHashKey("a")));
+            REQUIRE_EQ(parser.GetSize(), 2);
+            REQUIRE(parser.Contains("0 0 9 ? * THU"));
+        }
+    }
+}
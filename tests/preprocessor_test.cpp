@@ -1,14 +1,53 @@
 #include "doctest.hpp"
 
+#include <string>
+
 #include <oryx/chron/preprocessor.hpp>
 
 using namespace oryx::chron;
 
-// TODO: Expand these tests
-
 TEST_CASE("WeekMonthDayLiteralProcessor replaces correctly") {
     static constexpr std::string_view kExpr = "0 * * * JAN-feb MON-tue";
 
-    auto schedule = WeekMonthDayLiteralProcessor::Process(std::string(kExpr));
-    REQUIRE_EQ("0 * * * 1-2 1-2", schedule);
-}
\ No newline at end of file
+    REQUIRE_EQ("0 * * * 1-2 1-2", PreprocessExpression<WeekMonthDayLiteralProcessor>(kExpr));
+
+    GIVEN("Names outside of their fields") {
+        REQUIRE_EQ(PreprocessExpression<WeekMonthDayLiteralProcessor>("0 0 0 ? MON SUN"), "0 0 0 ? MON 0");
+        REQUIRE_EQ(PreprocessExpression<WeekMonthDayLiteralProcessor>("R(0-59) 0 0 ? Dec sat"), "R(0-59) 0 0 ? 12 6");
+    }
+
+    GIVEN("Names next to other characters") {
+        REQUIRE_EQ(PreprocessExpression<WeekMonthDayLiteralProcessor>("0 0 18 ? MAR/3 FRIL"), "0 0 18 ? 3/3 5L");
+        REQUIRE_EQ(PreprocessExpression<WeekMonthDayLiteralProcessor>("0 0 9\t?  * MON#2 2030"),
+                   "0 0 9\t?  * 1#2 2030");
+        REQUIRE_EQ(PreprocessExpression<WeekMonthDayLiteralProcessor>("0 0 0 ? * R(MON-FRI)"), "0 0 0 ? * R(1-5)");
+    }
+}
+
+TEST_CASE("Fused preprocessor") {
+    Preprocessor<DollarExpressionProcessor, WeekMonthDayLiteralProcessor> preprocessor;
+
+    GIVEN("An expression without any triggers") {
+        static constexpr std::string_view kExpr = "0 */5 * * * ?";
+        THEN("It is passed on as it is") {
+            auto result = preprocessor.Process(kExpr);
+            REQUIRE_EQ(result, kExpr);
+            REQUIRE_EQ(result.data(), kExpr.data());
+        }
+    }
+
+    GIVEN("Triggers of several processors") {
+        REQUIRE_EQ(preprocessor.Process("@daily"), "0 0 0 * * ?");
+        REQUIRE_EQ(preprocessor.Process("@unknown"), "@unknown");
+        REQUIRE_EQ(preprocessor.Process("0 0 12 ? JAN MON-FRI"), "0 0 12 ? 1 1-5");
+    }
+
+    GIVEN("An expression longer than the inline buffer") {
+        std::string seconds;
+        for (auto i = 0; i < 60; ++i) seconds += std::to_string(i) + ",";
+        seconds.pop_back();
+        auto expression = seconds + " 0 0 ? JAN,FEB,MAR,APR,MAY,JUN,JUL,AUG,SEP,OCT,NOV,DEC SUN";
+        REQUIRE_GT(expression.size(), ExpressionBuffer::kInlineSize);
+        REQUIRE_EQ(preprocessor.Process(expression), seconds + " 0 0 ? 1,2,3,4,5,6,7,8,9,10,11,12 0");
+    }
+}
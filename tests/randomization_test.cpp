@@ -1,6 +1,13 @@
 #include "doctest.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <random>
+#include <set>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 #include <oryx/chron/randomization.hpp>
 #include <oryx/chron/scheduler.hpp>
@@ -112,3 +119,162 @@ TEST_CASE("Randomization using text versions of days and months") {
         }
     }
 }
+
+TEST_CASE("Randomization templates") {
+    Randomization rng;
+
+    GIVEN("A template with random fields") {
+        auto pattern = RandomizationTemplate::Parse("R(10-19) 30 R(22-2) R(1-31) R(JAN-DEC) ?");
+        REQUIRE(pattern);
+        REQUIRE(pattern->IsRandom(RandomizationTemplate::Field::Seconds));
+        REQUIRE_FALSE(pattern->IsRandom(RandomizationTemplate::Field::Minutes));
+        REQUIRE(pattern->IsRandom(RandomizationTemplate::Field::Hours));
+        REQUIRE_FALSE(pattern->IsRandom(RandomizationTemplate::Field::Weekdays));
+        REQUIRE_EQ(pattern->GetMasks().hours, 0b111 | 0b11 << 22);
+
+        THEN("Every drawn schedule picks one candidate per random field") {
+            for (auto i = 0; i < 5000; ++i) {
+                auto masks = rng.Generate(*pattern);
+                REQUIRE(masks);
+                REQUIRE(masks->IsSatisfiable());
+                REQUIRE_EQ(std::popcount(masks->seconds), 1);
+                REQUIRE_EQ(std::countr_zero(masks->seconds) / 10, 1);
+                REQUIRE_EQ(masks->minutes, uint64_t{1} << 30);
+                REQUIRE_EQ(std::popcount(masks->hours), 1);
+                REQUIRE((masks->hours & pattern->GetMasks().hours));
+                REQUIRE_EQ(std::popcount(masks->months), 1);
+                REQUIRE_EQ(std::popcount(masks->days), 1);
+                if (masks->months == 1 << 2) {
+                    REQUIRE_LT(std::countr_zero(masks->days), 30);
+                }
+            }
+        }
+
+        THEN("Every candidate is drawn") {
+            uint64_t seen{};
+            for (auto i = 0; i < 1000; ++i) seen |= rng.Generate(*pattern)->seconds;
+            REQUIRE_EQ(seen, pattern->GetMasks().seconds);
+        }
+    }
+
+    GIVEN("Fixed days that do not exist in every random month") {
+        auto pattern = RandomizationTemplate::Parse("0 0 0 31 R(1-12) ?");
+        REQUIRE(pattern);
+
+        THEN("Only months with 31 days give a schedule") {
+            for (auto i = 0; i < 1000; ++i) {
+                if (auto masks = rng.Generate(*pattern)) {
+                    REQUIRE_EQ(std::popcount(masks->months), 1);
+                    REQUIRE((masks->months & 0b1'0101'1010'1010));
+                }
+            }
+        }
+    }
+
+    GIVEN("Invalid templates") {
+        REQUIRE_FALSE(RandomizationTemplate::Parse("R(0-60) 0 0 * * ?"));
+        REQUIRE_FALSE(RandomizationTemplate::Parse("0 0 0 1 R(JAN-DEC) R(MON-SUN)"));
+        REQUIRE_FALSE(RandomizationTemplate::Parse("0 61 0 ? * R(0-6)"));
+    }
+}
+
+TEST_CASE("Randomization generators") {
+    auto pattern = RandomizationTemplate::Parse("R(0-59) R(0-59) R(0-23) R(1-31) R(1-12) ?");
+    REQUIRE(pattern);
+
+    GIVEN("Two instances with the same seed") {
+        Randomization first{42};
+        Randomization second{42};
+
+        THEN("They draw the same schedules") {
+            for (auto i = 0; i < 1000; ++i) REQUIRE_EQ(first.Generate(*pattern), second.Generate(*pattern));
+        }
+    }
+
+    GIVEN("A fixed seed") {
+        Randomization rng{42};
+
+        THEN("It draws the same schedules on every platform") {
+            for (auto expected : {"48 19 23 24 9 ?", "35 7 14 29 3 ?", "33 51 16 13 1 ?"}) {
+                auto masks = rng.Generate(*pattern);
+                REQUIRE(masks);
+                REQUIRE_EQ(masks->ToCanonicalString(), expected);
+            }
+        }
+    }
+
+    GIVEN("Another generator") {
+        BasicRandomization<std::mt19937> rng{7};
+
+        THEN("Only valid schedules generated") {
+            for (auto i = 0; i < 1000; ++i) REQUIRE(rng.Generate(*pattern));
+        }
+    }
+
+    GIVEN("Several threads") {
+        std::vector<std::thread> threads;
+        std::array<std::size_t, 4> counts{};
+        for (auto& count : counts) {
+            threads.emplace_back([&pattern, &count] {
+                for (auto i = 0; i < 1000; ++i) count += Randomization::ForThisThread().Generate(*pattern).has_value();
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        THEN("Each uses its own instance") {
+            for (auto count : counts) REQUIRE_EQ(count, 1000);
+        }
+    }
+
+    GIVEN("Masks to select from") {
+        THEN("The set bits are found by their rank") {
+            REQUIRE_EQ(details::SelectBit(0b1011'0100, 0), 2);
+            REQUIRE_EQ(details::SelectBit(0b1011'0100, 1), 4);
+            REQUIRE_EQ(details::SelectBit(0b1011'0100, 3), 7);
+            REQUIRE_EQ(details::SelectBit(~uint64_t{0}, 63), 63);
+            REQUIRE_EQ(details::SelectBit(uint64_t{1} << 63 | 1, 1), 63);
+            static_assert(details::SelectBit(0b1011'0100, 2) == 5);
+        }
+    }
+}
+
+TEST_CASE("Load aware placement") {
+    Randomization rng{1};
+    Occupancy occupancy;
+
+    GIVEN("Tasks placed on a random second") {
+        auto pattern = RandomizationTemplate::Parse("R(0-59) 0 0 * * ?");
+        REQUIRE(pattern);
+        std::vector<ChronMasks> placed;
+        for (auto i = 0; i < 600; ++i) placed.push_back(rng.Place(*pattern, occupancy).value());
+
+        THEN("Every second gets the same number of them") {
+            REQUIRE(std::ranges::all_of(occupancy.GetSeconds(), [](auto count) { return count == 10; }));
+            REQUIRE_EQ(occupancy.GetMinutes()[0], 600);
+            REQUIRE_EQ(occupancy.GetHours()[0], 600);
+        }
+
+        AND_WHEN("Some of them are removed") {
+            for (auto i = 0; i < 3; ++i) occupancy.Remove(placed[static_cast<std::size_t>(i)]);
+            auto second = [](const ChronMasks& masks) { return std::countr_zero(masks.seconds); };
+
+            THEN("New ones fill the gaps first") {
+                std::set<int> removed{second(placed[0]), second(placed[1]), second(placed[2])};
+                std::set<int> filled;
+                for (auto i = 0; i < 3; ++i) filled.insert(second(rng.Place(*pattern, occupancy).value()));
+                REQUIRE_EQ(filled, removed);
+            }
+        }
+    }
+
+    GIVEN("Existing schedules added from expressions") {
+        occupancy.Add(ChronMasks(kParseExpression("0 0-29 * * * ?").value()));
+        auto pattern = RandomizationTemplate::Parse("0 R(0-59) 0 * * ?");
+        REQUIRE(pattern);
+
+        THEN("Placed tasks avoid their minutes") {
+            for (auto i = 0; i < 30; ++i) REQUIRE_GE(std::countr_zero(rng.Place(*pattern, occupancy)->minutes), 30);
+            REQUIRE(std::ranges::all_of(occupancy.GetMinutes(), [](auto count) { return count == 1; }));
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#include "doctest.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <oryx/chron/parser.hpp>
+#include <oryx/chron/schedule_matcher.hpp>
+
+using namespace oryx::chron;
+using namespace std::chrono;
+
+namespace {
+
+auto RandomMasks(std::mt19937_64& rng) -> ChronMasks {
+    ChronMasks masks;
+    masks.seconds = rng() & 0x0FFF'FFFF'FFFF'FFFF;
+    masks.minutes = rng() & 0x0FFF'FFFF'FFFF'FFFF;
+    masks.hours = static_cast<uint32_t>(rng() & 0xFF'FFFF);
+    masks.days = rng() % 2 ? static_cast<uint32_t>(rng() & ChronMasks::kAllMonthDays) : ChronMasks::kAllMonthDays;
+    masks.months = static_cast<uint16_t>(rng() & 0x1FFE);
+    masks.weeks = static_cast<uint8_t>(rng() & 0x7F);
+    return masks;
+}
+
+}  // namespace
+
+TEST_CASE("Matching many schedules at once") {
+    std::mt19937_64 rng{99};
+
+    std::vector<Schedule> schedules;
+    ScheduleMatcher matcher;
+    for (auto i = 0; i < 1003; ++i) {
+        schedules.emplace_back(RandomMasks(rng));
+        REQUIRE_EQ(matcher.Add(schedules.back()), static_cast<std::size_t>(i));
+    }
+
+    auto first = sys_days{2000y / 1 / 1}.time_since_epoch().count();
+    std::vector<uint64_t> bitmap;
+    std::vector<std::size_t> indices;
+
+    for (auto i = 0; i < 200; ++i) {
+        TimePoint time = sys_days{days{first + static_cast<int64_t>(rng() % 20000)}} + seconds{rng() % 86400};
+        matcher.Match(time, bitmap);
+        matcher.MatchIndices(time, indices);
+
+        REQUIRE_EQ(bitmap.size(), (schedules.size() + 63) / 64);
+        std::vector<std::size_t> expected;
+        for (std::size_t n = 0; n < schedules.size(); ++n) {
+            auto fires = schedules[n].CalculateFrom(time) == time;
+            REQUIRE_EQ((bitmap[n / 64] >> (n % 64) & 1) != 0, fires);
+            if (fires) expected.push_back(n);
+        }
+        REQUIRE_EQ(indices, expected);
+    }
+
+    GIVEN("Schedules restricted by day of month or day of week") {
+        matcher.Clear();
+        REQUIRE_EQ(matcher.GetSize(), 0);
+        matcher.Add(Schedule{kParseExpression("0 0 12 15 * ?").value()});
+        matcher.Add(Schedule{kParseExpression("0 0 12 ? * MON").value()});
+        matcher.Add(Schedule{kParseExpression("0 0 12 ? JAN *").value()});
+
+        // 2024-01-15 is a Monday.
+        matcher.MatchIndices(sys_days{2024y / 1 / 15} + hours{12}, indices);
+        REQUIRE_EQ(indices, std::vector<std::size_t>{0, 1, 2});
+        matcher.MatchIndices(sys_days{2024y / 2 / 15} + hours{12}, indices);
+        REQUIRE_EQ(indices, std::vector<std::size_t>{0});
+        matcher.MatchIndices(sys_days{2024y / 1 / 15} + hours{12} + seconds{1}, indices);
+        REQUIRE(indices.empty());
+    }
+
+    GIVEN("Schedules with Quartz style days or a year field") {
+        matcher.Clear();
+        matcher.Add(Schedule{kParseExpression("0 0 12 L * ?").value()});
+        matcher.Add(Schedule{kParseExpression("0 0 12 ? * MON#2").value()});
+        matcher.Add(Schedule{kParseExpression("0 0 12 * * ? 2024").value()});
+        matcher.Add(Schedule{kParseExpression("0 0 12 ? * 1L").value()});
+
+        matcher.MatchIndices(sys_days{2024y / 1 / 8} + hours{12}, indices);
+        REQUIRE_EQ(indices, std::vector<std::size_t>{1, 2});
+        matcher.MatchIndices(sys_days{2024y / 1 / 31} + hours{12}, indices);
+        REQUIRE_EQ(indices, std::vector<std::size_t>{0, 2});
+        matcher.MatchIndices(sys_days{2025y / 3 / 31} + hours{12}, indices);
+        REQUIRE_EQ(indices, std::vector<std::size_t>{0, 3});
+        matcher.MatchIndices(sys_days{2025y / 3 / 24} + hours{12}, indices);
+        REQUIRE(indices.empty());
+    }
+}
@@ -3,10 +3,14 @@
 
 #include <chrono>
 #include <array>
+#include <functional>
+#include <vector>
 #include <span>
 #include <iostream>
+#include <random>
 
 #include <oryx/chron/scheduler.hpp>
+#include <oryx/chron/details/civil.hpp>
 
 using namespace oryx::chron;
 using namespace std::chrono;
@@ -71,6 +75,70 @@ auto Test(std::string_view schedule, system_clock::time_point from, system_clock
     return res;
 }
 
+// Straightforward search on the calendar fields, used as reference for the mask based search.
+auto ReferenceCalculateFrom(const ChronData& data, TimePoint curr) -> std::optional<TimePoint> {
+    for (auto i = 0; i < std::numeric_limits<uint16_t>::max(); ++i) {
+        sys_days day = floor<days>(curr);
+        year_month_day ymd = day;
+        if (!data.months.contains(static_cast<Months>(unsigned(ymd.month())))) {
+            auto next_month = ymd + months{1};
+            curr = sys_days{next_month.year() / next_month.month() / 1};
+            continue;
+        }
+        auto month_day = static_cast<MonthDays>(unsigned(ymd.day()));
+        auto week_day = static_cast<Weekdays>(weekday(day).c_encoding());
+        bool day_allowed = data.days.size() != 31 ? data.days.contains(month_day) : data.weeks.contains(week_day);
+        if (!day_allowed) {
+            curr = day + days{1};
+            continue;
+        }
+
+        hh_mm_ss time{floor<seconds>(curr - day)};
+        if (!data.hours.contains(static_cast<Hours>(time.hours().count()))) {
+            curr = day + time.hours() + hours{1};
+        } else if (!data.minutes.contains(static_cast<Minutes>(time.minutes().count()))) {
+            curr = day + time.hours() + time.minutes() + minutes{1};
+        } else if (!data.seconds.contains(static_cast<Seconds>(time.seconds().count()))) {
+            curr = day + time.hours() + time.minutes() + time.seconds() + seconds{1};
+        } else {
+            return floor<seconds>(curr);
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T>
+auto RandomField(std::mt19937& rng, int first, int last, int max_values) -> std::set<T> {
+    std::set<T> values;
+    auto count = std::uniform_int_distribution(1, max_values)(rng);
+    for (auto i = 0; i < count; ++i) {
+        values.emplace(static_cast<T>(std::uniform_int_distribution(first, last)(rng)));
+    }
+    return values;
+}
+
+auto RandomData(std::mt19937& rng) -> ChronData {
+    ChronData data;
+    data.seconds = RandomField<Seconds>(rng, 0, 59, 4);
+    data.minutes = RandomField<Minutes>(rng, 0, 59, 4);
+    data.hours = RandomField<Hours>(rng, 0, 23, 3);
+    data.months = RandomField<Months>(rng, 1, 12, 6);
+    if (rng() % 2) {
+        data.days = RandomField<MonthDays>(rng, 1, 31, 3);
+        data.weeks = RandomField<Weekdays>(rng, 0, 6, 7);
+    } else {
+        for (auto d = 1; d <= 31; ++d) data.days.emplace(static_cast<MonthDays>(d));
+        data.weeks = RandomField<Weekdays>(rng, 0, 6, 3);
+    }
+    return data;
+}
+
+auto RandomTime(std::mt19937& rng) -> TimePoint {
+    auto first = duration_cast<milliseconds>(sys_days{1990y / 1 / 1}.time_since_epoch()).count();
+    auto last = duration_cast<milliseconds>(sys_days{2060y / 1 / 1}.time_since_epoch()).count();
+    return TimePoint{} + milliseconds{std::uniform_int_distribution<int64_t>(first, last)(rng)};
+}
+
 }  // namespace
 
 TEST_CASE("Calculating next runtime") {
@@ -169,4 +237,389 @@ TEST_CASE("Examples from README.md") {
 
 TEST_CASE("Unable to calculate time point") {
     REQUIRE_FALSE(Test("0 0 * 31 FEB *", DT(2021y / 1 / 1), DT(2022y / 1 / 1)));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Calendar conversion agrees with std::chrono") {
+    constexpr auto kFirst = sys_days{1600y / 1 / 1}.time_since_epoch().count();
+    constexpr auto kLast = sys_days{2400y / 12 / 31}.time_since_epoch().count();
+
+    details::DayCursor cursor(kFirst);
+    for (auto day = kFirst; day <= kLast; ++day, cursor.NextDay()) {
+        year_month_day ymd{sys_days{days{day}}};
+        weekday wd{sys_days{days{day}}};
+        auto date = details::CivilFromDays(day);
+
+        REQUIRE_EQ(date.year, int(ymd.year()));
+        REQUIRE_EQ(date.month, unsigned(ymd.month()));
+        REQUIRE_EQ(date.day, unsigned(ymd.day()));
+        REQUIRE_EQ(date.weekday, wd.c_encoding());
+        REQUIRE_EQ(details::DaysFromCivil(date.year, date.month, date.day), day);
+        REQUIRE_EQ(details::LastDayOfMonth(date.year, date.month), unsigned((ymd.year() / ymd.month() / last).day()));
+
+        REQUIRE_EQ(cursor.GetDays(), day);
+        REQUIRE_EQ(cursor.GetDate().year, date.year);
+        REQUIRE_EQ(cursor.GetDate().month, date.month);
+        REQUIRE_EQ(cursor.GetDate().day, date.day);
+        REQUIRE_EQ(cursor.GetDate().weekday, date.weekday);
+    }
+
+    details::DayCursor backwards(kLast);
+    for (auto day = kLast; day >= kFirst; --day, backwards.PrevDay()) {
+        auto date = details::CivilFromDays(day);
+        REQUIRE_EQ(backwards.GetDays(), day);
+        REQUIRE_EQ(backwards.GetDate().day, date.day);
+        REQUIRE_EQ(backwards.GetDate().month, date.month);
+        REQUIRE_EQ(backwards.GetDate().weekday, date.weekday);
+    }
+
+    auto time = DT(2024y / 2 / 29, hours{23}, minutes{59}, seconds{58}) + milliseconds{999};
+    auto dt = Schedule::ToCalendarTime(time);
+    REQUIRE_EQ(dt.year, 2024);
+    REQUIRE_EQ(dt.month, 2);
+    REQUIRE_EQ(dt.day, 29);
+    REQUIRE_EQ(dt.hour, 23);
+    REQUIRE_EQ(dt.min, 59);
+    REQUIRE_EQ(dt.sec, 58);
+    REQUIRE_EQ(dt.weekday, 4);
+}
+
+TEST_CASE("Mask based search agrees with the reference search") {
+    std::mt19937 rng{42};
+
+    for (auto i = 0; i < 2000; ++i) {
+        auto data = RandomData(rng);
+        auto from = RandomTime(rng);
+        Schedule schedule{data};
+        Task task("task", schedule, [](auto) {});
+
+        for (auto n = 0; n < 5; ++n) {
+            auto expected = ReferenceCalculateFrom(data, from);
+            if (!expected) break;
+
+            REQUIRE_EQ(schedule.CalculateFrom(from), expected);
+            REQUIRE(task.CalculateNext(from));
+            REQUIRE_EQ(task.GetNextSchedule(), expected.value());
+            from = expected.value() + seconds{1};
+        }
+    }
+}
+
+TEST_CASE("Batch occurrences") {
+    static_assert(std::ranges::input_range<Schedule::OccurrenceRange>);
+
+    std::mt19937 rng{7};
+
+    for (auto i = 0; i < 500; ++i) {
+        auto data = RandomData(rng);
+        auto from = RandomTime(rng);
+        Schedule schedule{data};
+
+        std::vector<TimePoint> expected;
+        for (auto time = schedule.CalculateFrom(from); time && expected.size() < 20;
+             time = schedule.CalculateFrom(time.value() + seconds{1})) {
+            expected.push_back(time.value());
+        }
+
+        std::array<TimePoint, 20> batch{};
+        auto count = schedule.NextN(from, batch);
+        REQUIRE_EQ(count, expected.size());
+        REQUIRE(std::equal(expected.begin(), expected.end(), batch.begin()));
+
+        if (expected.empty()) {
+            REQUIRE(schedule.Occurrences(from, TimePoint::max()).begin() == std::default_sentinel);
+            continue;
+        }
+
+        auto until = expected.back();
+        std::vector<TimePoint> lazy;
+        for (auto time : schedule.Occurrences(from, until)) {
+            lazy.push_back(time);
+        }
+        REQUIRE_EQ(lazy.size(), expected.size() - 1);
+        REQUIRE(std::equal(lazy.begin(), lazy.end(), expected.begin()));
+    }
+
+    GIVEN("A schedule without any valid time") {
+        auto data = kParseExpression("0 0 * 31 * ?").value();
+        data.months = {Months::February};
+        Schedule schedule{data};
+        std::array<TimePoint, 3> batch{};
+        REQUIRE_EQ(schedule.NextN(DT(2021y / 1 / 1), batch), 0);
+    }
+}
+
+TEST_CASE("Reverse search agrees with the forward search") {
+    std::mt19937 rng{1234};
+
+    for (auto i = 0; i < 2000; ++i) {
+        auto data = RandomData(rng);
+        auto at = RandomTime(rng);
+        Schedule schedule{data};
+
+        auto previous = schedule.CalculatePrevious(at);
+        if (previous) {
+            REQUIRE_LE(previous.value(), at);
+            REQUIRE_EQ(schedule.CalculateFrom(previous.value()), previous);
+            auto after = schedule.CalculateFrom(previous.value() + seconds{1});
+            REQUIRE((!after || after.value() > at));
+        } else {
+            auto next = schedule.CalculateFrom(at - years{4});
+            REQUIRE((!next || next.value() > at));
+        }
+
+        auto next = schedule.CalculateFrom(at);
+        if (next) {
+            REQUIRE_EQ(schedule.CalculatePrevious(next.value()), next);
+            if (next.value() > floor<seconds>(at)) {
+                REQUIRE_EQ(schedule.CalculatePrevious(next.value() - seconds{1}), previous);
+            }
+        }
+    }
+
+    GIVEN("Boundaries of the calendar") {
+        Schedule schedule{kParseExpression("59 59 23 29,31 * ?").value()};
+        REQUIRE_EQ(schedule.CalculatePrevious(DT(2024y / 3 / 1)),
+                   DT(2024y / 2 / 29, hours{23}, minutes{59}, seconds{59}));
+        REQUIRE_EQ(schedule.CalculatePrevious(DT(2024y / 1 / 1)),
+                   DT(2023y / 12 / 31, hours{23}, minutes{59}, seconds{59}));
+
+        Schedule fridays{kParseExpression("0 0 0 ? * FRI").value()};
+        REQUIRE_EQ(fridays.CalculatePrevious(DT(2024y / 3 / 1, hours{0}, minutes{0}, seconds{0})), DT(2024y / 3 / 1));
+        REQUIRE_EQ(fridays.CalculatePrevious(DT(2024y / 2 / 29)), DT(2024y / 2 / 23));
+        REQUIRE_EQ(fridays.CalculatePrevious(DT(2024y / 1 / 4)), DT(2023y / 12 / 29));
+    }
+}
+
+TEST_CASE("Schedules that never run are rejected") {
+    for (auto expression : {"0 0 0 30 2 ?", "0 0 0 31 4,6 ?", "0 0 0 30,31 2 ?", "0 0 0 31 2,4,6,9,11 ?"}) {
+        CAPTURE(expression);
+        REQUIRE_FALSE(kParseExpression(expression));
+    }
+    for (auto expression : {"0 0 0 29 2 ?", "0 0 0 31 2,3 ?", "0 0 0 30,31 2,4 ?", "0 0 0 ? 2 MON"}) {
+        CAPTURE(expression);
+        REQUIRE(kParseExpression(expression));
+    }
+
+    ChronMasks masks;
+    masks.seconds = masks.minutes = masks.hours = 1;
+    masks.days = ChronMasks::kAllMonthDays;
+    masks.months = 1 << 3;
+    REQUIRE_FALSE(Schedule(masks).GetGaps());
+    masks.weeks = 1 << 5;
+    REQUIRE(masks.IsSatisfiable());
+}
+
+TEST_CASE("Gaps between occurrences") {
+    struct Expected {
+        std::string_view expression;
+        seconds min;
+        seconds max;
+    };
+
+    static constexpr std::array kExpected{
+        Expected{"*/15 * * * * ?", 15s, 15s},
+        Expected{"0 0 12 * * ?", days{1}, days{1}},
+        Expected{"0 0 8,20 * * ?", 12h, 12h},
+        Expected{"0 0 9-17 * * ?", 1h, 16h},
+        Expected{"0 0 9 ? * MON-FRI", days{1}, days{3}},
+        Expected{"0 0 0 31 * ?", days{31}, days{61}},
+        Expected{"0 0 0 29 2 ?", days{4 * 365 + 1}, days{8 * 365 + 1}},
+        Expected{"0 30 6 ? * SUN", days{7}, days{7}},
+    };
+
+    for (const auto& expected : kExpected) {
+        CAPTURE(expected.expression);
+        auto gaps = Schedule(kParseExpression(expected.expression).value()).GetGaps();
+        REQUIRE(gaps);
+        REQUIRE_EQ(gaps->min, expected.min);
+        REQUIRE_EQ(gaps->max, expected.max);
+    }
+}
+
+TEST_CASE("Quartz style days and years") {
+    GIVEN("Days relative to the end of the month") {
+        REQUIRE(Test("0 0 0 L * ?", DT(2024y / 2 / 10), DT(2024y / 2 / 29)));
+        REQUIRE(Test("0 0 0 L * ?", DT(2023y / 2 / 10), DT(2023y / 2 / 28)));
+        REQUIRE(Test("0 0 0 L-2 * ?", DT(2024y / 4 / 1), DT(2024y / 4 / 28)));
+        REQUIRE(Test("0 0 0 LW * ?", DT(2024y / 3 / 1), DT(2024y / 3 / 29)));
+    }
+
+    GIVEN("Nearest weekdays") {
+        REQUIRE(Test("0 0 0 15W * ?", DT(2024y / 6 / 1), DT(2024y / 6 / 14)));
+        REQUIRE(Test("0 0 0 15W * ?", DT(2024y / 9 / 1), DT(2024y / 9 / 16)));
+        // Never leaves the month, a Saturday the 1st moves ahead to Monday the 3rd.
+        REQUIRE(Test("0 0 0 1W * ?", DT(2024y / 6 / 1), DT(2024y / 6 / 3)));
+        REQUIRE(Test("0 0 0 30W * ?", DT(2024y / 6 / 1), DT(2024y / 6 / 28)));
+    }
+
+    GIVEN("Weekdays of a certain week") {
+        REQUIRE(Test("0 0 9 ? * MON#2", DT(2024y / 1 / 1), DT(2024y / 1 / 8, hours{9})));
+        REQUIRE(Test("0 0 0 ? * 1#5", DT(2024y / 2 / 1), DT(2024y / 4 / 29)));
+
+        // Last Friday of the quarter.
+        constexpr std::array expected{DT(2024y / 3 / 29, hours{18}), DT(2024y / 6 / 28, hours{18}),
+                                      DT(2024y / 9 / 27, hours{18}), DT(2024y / 12 / 27, hours{18})};
+        REQUIRE(Test("0 0 18 ? 3,6,9,12 FRIL", DT(2024y / 1 / 1), expected));
+    }
+
+    GIVEN("A year field") {
+        REQUIRE(Test("0 0 12 1 1 ? 2030", DT(2024y / 1 / 1), DT(2030y / 1 / 1, hours{12})));
+        REQUIRE_FALSE(Schedule(kParseExpression("0 0 12 1 1 ? 2030").value()).CalculateFrom(DT(2031y / 1 / 1)));
+        REQUIRE_EQ(Schedule(kParseExpression("0 0 12 L 2 ? 2025-2030").value()).CalculatePrevious(DT(2040y / 1 / 1)),
+                   DT(2030y / 2 / 28, hours{12}));
+        // A year field that allows every year is the same as none, runs go on after its end.
+        REQUIRE(Test("0 0 0 1 1 ? 1970-2099", DT(2099y / 6 / 1), DT(2100y / 1 / 1)));
+    }
+
+    GIVEN("Days that never exist") {
+        REQUIRE_FALSE(kParseExpression("0 0 0 31W 2,4 ?"));
+        REQUIRE(kParseExpression("0 0 0 ? 2 0#5"));
+        REQUIRE_FALSE(kParseExpression("0 0 0 ? 2 0#5 2025"));
+        REQUIRE_FALSE(kParseExpression("0 0 0 29 2 ? 2025-2027"));
+    }
+
+    GIVEN("Occurrences compared with a direct check of every day") {
+        auto nearest_weekday = [](year_month month, unsigned day) {
+            auto last_day = static_cast<unsigned>((month / last).day());
+            auto weekday = std::chrono::weekday(sys_days{month / day});
+            if (weekday == Saturday) return day == 1 ? 3u : day - 1;
+            if (weekday == Sunday) return day == last_day ? day - 2 : day + 1;
+            return day;
+        };
+        struct Reference {
+            std::string_view expression;
+            std::function<bool(year_month_day)> runs;
+        };
+        const std::array references{
+            Reference{"0 0 0 L-3 * ?",
+                      [](year_month_day d) { return d.day() + days{3} == (d.year() / d.month() / last).day(); }},
+            Reference{"0 0 0 1,LW * ?",
+                      [&](year_month_day d) {
+                          auto month = d.year() / d.month();
+                          auto last_day = static_cast<unsigned>((month / last).day());
+                          return d.day() == 1d || static_cast<unsigned>(d.day()) == nearest_weekday(month, last_day);
+                      }},
+            Reference{"0 0 0 1W,31W * ?",
+                      [&](year_month_day d) {
+                          auto month = d.year() / d.month();
+                          auto day = static_cast<unsigned>(d.day());
+                          return day == nearest_weekday(month, 1) ||
+                                 ((month / last).day() == 31d && day == nearest_weekday(month, 31));
+                      }},
+            Reference{"0 0 0 ? * 2L,0#1",
+                      [](year_month_day d) {
+                          auto weekday = std::chrono::weekday(sys_days{d});
+                          auto last_week = sys_days{d} + days{7} > sys_days{d.year() / d.month() / last};
+                          return (weekday == Tuesday && last_week) || (weekday == Sunday && d.day() <= 7d);
+                      }},
+            Reference{"0 0 0 ? 2 3#5 2000-2060", [](year_month_day d) {
+                          return d.month() == February && std::chrono::weekday(sys_days{d}) == Wednesday &&
+                                 d.day() > 28d && d.year() <= 2060y;
+                      }},
+        };
+
+        for (const auto& reference : references) {
+            CAPTURE(reference.expression);
+            Schedule schedule{kParseExpression(reference.expression).value()};
+
+            std::vector<TimePoint> expected;
+            for (auto day = sys_days{1999y / 12 / 1}; day < sys_days{2101y / 1 / 1}; day += days{1}) {
+                if (reference.runs(year_month_day{day})) expected.push_back(day);
+            }
+
+            std::vector<TimePoint> found;
+            for (auto time : schedule.Occurrences(DT(1999y / 12 / 1), DT(2101y / 1 / 1))) found.push_back(time);
+            REQUIRE(found == expected);
+
+            for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+                REQUIRE_EQ(schedule.CalculatePrevious(*it + hours{12}), *it);
+            }
+        }
+    }
+
+    GIVEN("Gaps within the years of the year field") {
+        auto gaps = Schedule(kParseExpression("0 0 0 1 1 ? 2030,2032,2040").value()).GetGaps();
+        REQUIRE(gaps);
+        REQUIRE_EQ(gaps->min, days{2 * 365});
+        REQUIRE_EQ(gaps->max, days{8 * 365 + 2});
+        REQUIRE_FALSE(Schedule(kParseExpression("0 0 0 1 1 ? 2030").value()).GetGaps());
+        REQUIRE_EQ(Schedule(kParseExpression("0 0 0 L * ?").value()).GetGaps()->min, days{28});
+    }
+}
+
+TEST_CASE("Schedule kinds") {
+    GIVEN("Common shapes") {
+        static constexpr std::pair<std::string_view, Schedule::Kind> kKinds[] = {
+            {"*/15 * * * * ?", Schedule::Kind::Interval}, {"0 */5 * * * ?", Schedule::Kind::Interval},
+            {"0 30 2 * * ?", Schedule::Kind::Interval},   {"10 0 */6 * * ?", Schedule::Kind::Interval},
+            {"*/7 * * * * ?", Schedule::Kind::Daily},     {"0 0 8,12,18 * * ?", Schedule::Kind::Daily},
+            {"0 */5 9-17 * * ?", Schedule::Kind::Daily},  {"0 0 9 ? * MON-FRI", Schedule::Kind::Weekly},
+            {"0 30 2 1 * ?", Schedule::Kind::General},    {"0 0 0 * JAN-JUN ?", Schedule::Kind::General},
+            {"0 0 0 L * ?", Schedule::Kind::General},     {"0 0 0 * * ? 2030", Schedule::Kind::General},
+        };
+
+        for (auto [expression, kind] : kKinds) {
+            CAPTURE(expression);
+            REQUIRE(Schedule(kParseExpression(expression).value()).GetKind() == kind);
+        }
+    }
+
+    GIVEN("Random schedules of every shape") {
+        static constexpr std::array kDivisorsOf60{1, 2, 3, 4, 5, 6, 10, 12, 15, 20, 30, 60};
+        static constexpr std::array kDivisorsOf24{1, 2, 3, 4, 6, 8, 12, 24};
+        std::mt19937 rng{43};
+
+        auto even = [&]<typename T>(std::set<T>& values, std::span<const int> divisors, int width) {
+            auto step = divisors[rng() % divisors.size()];
+            values.clear();
+            for (auto value = static_cast<int>(rng() % step); value < width; value += step) {
+                values.emplace(static_cast<T>(value));
+            }
+        };
+
+        for (auto i = 0; i < 2000; ++i) {
+            auto data = kParseExpression("* * * * * ?").value();
+            switch (i % 5) {
+                case 0:
+                    even(data.seconds, kDivisorsOf60, 60);
+                    break;
+                case 1:
+                    data.seconds = RandomField<Seconds>(rng, 0, 59, 1);
+                    even(data.minutes, kDivisorsOf60, 60);
+                    break;
+                case 2:
+                    data.seconds = RandomField<Seconds>(rng, 0, 59, 1);
+                    data.minutes = RandomField<Minutes>(rng, 0, 59, 1);
+                    even(data.hours, kDivisorsOf24, 24);
+                    break;
+                case 3:
+                    data.seconds = RandomField<Seconds>(rng, 0, 59, 4);
+                    data.minutes = RandomField<Minutes>(rng, 0, 59, 4);
+                    data.hours = RandomField<Hours>(rng, 0, 23, 3);
+                    break;
+                default:
+                    data.seconds = RandomField<Seconds>(rng, 0, 59, 4);
+                    data.minutes = RandomField<Minutes>(rng, 0, 59, 4);
+                    data.hours = RandomField<Hours>(rng, 0, 23, 3);
+                    data.weeks = RandomField<Weekdays>(rng, 0, 6, 4);
+                    break;
+            }
+
+            Schedule schedule{data};
+            REQUIRE(schedule.GetKind() != Schedule::Kind::General);
+            Task task("task", schedule, [](auto) {});
+            auto from = RandomTime(rng);
+            REQUIRE(task.CalculateNext(from));
+
+            std::array<TimePoint, 5> batch{};
+            REQUIRE_EQ(schedule.NextN(from, batch), batch.size());
+            for (auto expected : batch) {
+                REQUIRE_EQ(ReferenceCalculateFrom(data, from), expected);
+                REQUIRE_EQ(schedule.CalculateFrom(from), expected);
+                REQUIRE_EQ(task.GetNextSchedule(), expected);
+                from = expected + seconds{1};
+                REQUIRE(task.CalculateNext(from));
+            }
+        }
+    }
+}
@@ -2,9 +2,18 @@
 
 #include <oryx/chron/scheduler.hpp>
 
+#include <algorithm>
 #include <thread>
 #include <chrono>
+#include <filesystem>
 #include <format>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <vector>
 
 using namespace oryx::chron;
 using namespace std::chrono;
@@ -30,6 +39,14 @@ private:
     system_clock::time_point current_time_{};
 };
 
+// Fails in a way a parser should not, to see where the exception ends up.
+struct ThrowingParser {
+    auto operator()(std::string_view cron_expression) const -> std::optional<ChronData> {
+        if (cron_expression == "throw") throw std::runtime_error("parser failed");
+        return kParseExpression(cron_expression);
+    }
+};
+
 auto CreateScheduleExpiringIn(system_clock::time_point now, hours h, minutes m, seconds s) -> std::string {
     now = now + h + m + s;
     auto dt = Schedule::ToCalendarTime(now);
@@ -38,6 +55,9 @@ auto CreateScheduleExpiringIn(system_clock::time_point now, hours h, minutes m,
 
 }  // namespace
 
+template <>
+struct oryx::chron::traits::IsConcurrentParser<ThrowingParser> : std::true_type {};
+
 TEST_CASE("Adding a task") {
     GIVEN("A Scheduler instance with no task") {
         Scheduler sched{};
@@ -354,4 +374,538 @@ TEST_CASE("Adding a batch of tasks") {
         REQUIRE_EQ(scheduler.Tick(), 2);
         REQUIRE_EQ(counter, 2);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Tasks with their own time zone") {
+    GIVEN("A UTC scheduler with a task at 02:30 in Europe/Berlin") {
+        Scheduler<TestClock> sched{};
+        auto& clock = sched.GetClock();
+        int run_count{};
+
+        WHEN("The wall time is skipped by the transition to summer time") {
+            clock.SetTime(sys_days{2024y / 3 / 30} + 12h);
+            REQUIRE(sched.AddSchedule("Skipped", "0 30 2 * * ?", "Europe/Berlin", [&run_count](auto) { run_count++; }));
+
+            THEN("Task runs once at the transition and on wall time afterwards") {
+                REQUIRE_EQ(clock.Now() + sched.TimeUntilNext(), sys_days{2024y / 3 / 31} + 1h);
+                clock.SetTime(sys_days{2024y / 3 / 31} + 1h);
+                REQUIRE_EQ(sched.Tick(), 1);
+                REQUIRE_EQ(clock.Now() + sched.TimeUntilNext(), sys_days{2024y / 4 / 1} + 30min);
+            }
+        }
+        AND_WHEN("The wall time is repeated by the transition to winter time") {
+            clock.SetTime(sys_days{2024y / 10 / 26} + 12h);
+            REQUIRE(
+                sched.AddSchedule("Repeated", "0 30 2 * * ?", "Europe/Berlin", [&run_count](auto) { run_count++; }));
+
+            THEN("Task runs only on the first occurrence") {
+                REQUIRE_EQ(clock.Now() + sched.TimeUntilNext(), sys_days{2024y / 10 / 27} + 30min);
+                clock.SetTime(sys_days{2024y / 10 / 27} + 30min);
+                REQUIRE_EQ(sched.Tick(), 1);
+                REQUIRE_EQ(clock.Now() + sched.TimeUntilNext(), sys_days{2024y / 10 / 28} + 1h + 30min);
+            }
+        }
+    }
+
+    GIVEN("A UTC scheduler with tasks in several time zones") {
+        Scheduler<TestClock> sched{};
+        auto& clock = sched.GetClock();
+        clock.SetTime(sys_days{2024y / 7 / 1} + 1h);
+        std::vector<std::string> order;
+
+        auto record = [&order](TaskInfo info) { order.emplace_back(info.name); };
+        REQUIRE(sched.AddSchedule("New York", "0 0 9 * * ?", "America/New_York", record));
+        REQUIRE(sched.AddSchedule("Tokyo", "0 0 9 * * ?", "Asia/Tokyo", record));
+        REQUIRE(sched.AddSchedule("Berlin", "0 0 9 * * ?", "Europe/Berlin", record));
+        REQUIRE_FALSE(sched.AddSchedule("Nowhere", "0 0 9 * * ?", "404Not/Found", record));
+
+        THEN("Every task runs at 09:00 of its own time zone") {
+            clock.SetTime(sys_days{2024y / 7 / 1} + 7h);
+            REQUIRE_EQ(sched.Tick(), 1);
+            clock.SetTime(sys_days{2024y / 7 / 1} + 13h);
+            REQUIRE_EQ(sched.Tick(), 1);
+            clock.SetTime(sys_days{2024y / 7 / 2} + 0h);
+            REQUIRE_EQ(sched.Tick(), 1);
+            REQUIRE_EQ(order, std::vector<std::string>{"Berlin", "New York", "Tokyo"});
+        }
+    }
+}
+
+TEST_CASE("Misfire policies") {
+    GIVEN("A task running every hour and a gap of five and a half hours") {
+        Scheduler<TestClock> sched{};
+        auto& clock = sched.GetClock();
+        clock.SetTime(sys_days{2024y / 1 / 1} + minutes{30});
+
+        std::vector<TaskInfo> runs;
+        REQUIRE(sched.AddSchedule("Hourly", "0 0 * * * ?", [&runs](TaskInfo info) { runs.push_back(info); }));
+        REQUIRE(sched.Tick() == 0);
+        clock.Advance(hours{5} + minutes{30});  // 06:00
+
+        WHEN("Using the default policy") {
+            THEN("The task is rescheduled and runs only if the current time is an occurrence") {
+                REQUIRE(sched.Tick() == 1);
+                REQUIRE(runs[0].scheduled == clock.Now());
+                REQUIRE(runs[0].delay == 0s);
+            }
+        }
+        AND_WHEN("Firing once") {
+            sched.SetMisfirePolicy({.action = MisfireAction::FireOnce});
+            THEN("The first missed occurrence runs once") {
+                REQUIRE(sched.Tick() == 1);
+                REQUIRE(runs[0].scheduled == sys_days{2024y / 1 / 1} + hours{1});
+                REQUIRE(runs[0].delay == hours{5});
+                clock.Advance(minutes{30});
+                REQUIRE(sched.Tick() == 0);
+            }
+        }
+        AND_WHEN("Firing all missed occurrences") {
+            sched.SetMisfirePolicy({.action = MisfireAction::FireAll});
+            THEN("Every occurrence runs in order") {
+                REQUIRE(sched.Tick() == 6);
+                for (std::size_t i = 0; i < runs.size(); ++i) {
+                    REQUIRE(runs[i].scheduled == sys_days{2024y / 1 / 1} + hours{i + 1});
+                    REQUIRE(runs[i].delay == hours{5 - i});
+                }
+                REQUIRE(sched.Tick() == 0);
+            }
+        }
+        AND_WHEN("Firing all missed occurrences up to a limit") {
+            sched.SetMisfirePolicy({.action = MisfireAction::FireAll, .max_runs = 2});
+            THEN("The remaining occurrences are dropped") {
+                REQUIRE(sched.Tick() == 2);
+                REQUIRE(runs[1].scheduled == sys_days{2024y / 1 / 1} + hours{2});
+                clock.Advance(minutes{30});
+                REQUIRE(sched.Tick() == 0);
+                clock.Advance(minutes{30});
+                REQUIRE(sched.Tick() == 1);
+            }
+        }
+        AND_WHEN("Skipping missed occurrences") {
+            sched.SetMisfirePolicy({.action = MisfireAction::Skip, .tolerance = minutes{1}});
+            THEN("Only the occurrence at the current time runs") {
+                REQUIRE(sched.Tick() == 1);
+                REQUIRE(runs[0].scheduled == sys_days{2024y / 1 / 1} + hours{6});
+            }
+            AND_THEN("Nothing runs if the current time is no occurrence") {
+                clock.Advance(minutes{5});
+                REQUIRE(sched.Tick() == 0);
+                REQUIRE(sched.Tick(clock.Now() + minutes{55}) == 1);
+            }
+        }
+        AND_WHEN("A task has a policy of its own") {
+            sched.SetMisfirePolicy({.action = MisfireAction::FireAll});
+            REQUIRE(sched.SetMisfirePolicy("Hourly", MisfirePolicy{.action = MisfireAction::FireOnce}));
+            REQUIRE_FALSE(sched.SetMisfirePolicy("Unknown", std::nullopt));
+            THEN("It takes precedence over the one of the scheduler") { REQUIRE(sched.Tick() == 1); }
+        }
+    }
+}
+
+TEST_CASE("Replaying a gap") {
+    Scheduler<TestClock> sched{};
+    auto& clock = sched.GetClock();
+    auto start = sys_days{2024y / 1 / 1};
+    clock.SetTime(start);
+
+    std::vector<std::pair<std::string, TimePoint>> runs;
+    auto record = [&runs](TaskInfo info) {
+        REQUIRE(info.delay == 0s);
+        runs.emplace_back(info.name, info.scheduled);
+    };
+    REQUIRE(sched.AddSchedule("Hourly", "0 0 * * * ?", record));
+    REQUIRE(sched.AddSchedule("Twice every three hours", "0 0,30 1/3 * * ?", record));
+    REQUIRE(sched.AddSchedule("Daily", "0 0 12 * * ?", record));
+    REQUIRE(sched.Tick() == 1);
+    runs.clear();
+
+    REQUIRE(sched.TickUntil(start + hours{12}) == 12 + 8 + 1);
+    REQUIRE(std::ranges::is_sorted(runs, {}, &std::pair<std::string, TimePoint>::second));
+    REQUIRE(runs.front().second == start + hours{1});
+    REQUIRE(runs.back().second == start + hours{12});
+
+    // The replay counts as the last tick, so nothing is late afterwards.
+    clock.SetTime(start + hours{12} + minutes{30});
+    runs.clear();
+    REQUIRE(sched.Tick() == 0);
+    REQUIRE(sched.TickUntil(start + hours{12} + minutes{30}) == 0);
+
+    // Replaying up to an earlier time does not move the scheduler back.
+    REQUIRE(sched.TickUntil(start + hours{6}) == 0);
+    REQUIRE(runs.empty());
+    clock.SetTime(start + hours{13});
+    REQUIRE(sched.Tick() == 2);
+}
+
+TEST_CASE("Recalculating lazily after a clock change") {
+    GIVEN("Two schedulers with the same tasks, one recalculating a few tasks per tick") {
+        Scheduler<TestClock> eager{};
+        Scheduler<TestClock> lazy{};
+        lazy.SetRecalculationBudget(3);
+
+        std::size_t lazy_runs{};
+        for (auto* sched : {&eager, &lazy}) {
+            sched->GetClock().SetTime(sys_days{2024y / 1 / 1} + hours{12} + minutes{1});
+            for (auto i = 0; i < 10; ++i) {
+                auto expr = std::format("0 {} */2 * * ?", i * 5);
+                REQUIRE(sched->AddSchedule(std::format("Task {}", i), expr, [&lazy_runs, sched, &lazy](auto) {
+                    if (sched == &lazy) lazy_runs++;
+                }));
+            }
+            REQUIRE(sched->Tick() == 0);
+            sched->GetClock().Advance(-hours{5});
+        }
+
+        WHEN("The clock moved back") {
+            REQUIRE(eager.Tick() == 0);
+            REQUIRE(lazy.Tick() == 0);
+
+            THEN("Pending tasks make the next tick due immediately") {
+                REQUIRE(lazy.TimeUntilNext() == 0s);
+                REQUIRE(eager.TimeUntilNext() > 0s);
+            }
+            AND_THEN("Status already reflects the recalculated schedules") {
+                REQUIRE(lazy.GetTasksStatus().size() == 10);
+                auto lazy_status = lazy.GetTasksStatus();
+                auto eager_status = eager.GetTasksStatus();
+                std::ranges::sort(lazy_status);
+                std::ranges::sort(eager_status);
+                REQUIRE(lazy_status == eager_status);
+            }
+            AND_THEN("All tasks are recalculated after a few ticks") {
+                for (auto i = 0; i < 3; ++i) REQUIRE(lazy.Tick() == 0);
+                REQUIRE(lazy.TimeUntilNext() == eager.TimeUntilNext());
+                REQUIRE(lazy.GetTasksStatus() == eager.GetTasksStatus());
+
+                lazy.GetClock().Advance(hours{1});
+                eager.GetClock().Advance(hours{1});
+                REQUIRE(lazy.Tick() == eager.Tick());
+                REQUIRE(lazy_runs == 1);
+            }
+            AND_THEN("Removing tasks keeps the pending ones apart") {
+                lazy.RemoveSchedule("Task 0");
+                lazy.RemoveSchedule("Task 9");
+                REQUIRE(lazy.GetNumTasks() == 8);
+                eager.RemoveSchedule("Task 0");
+                eager.RemoveSchedule("Task 9");
+                for (auto i = 0; i < 3; ++i) lazy.Tick();
+                REQUIRE(lazy.GetTasksStatus() == eager.GetTasksStatus());
+            }
+        }
+    }
+}
+
+TEST_CASE("Adding a batch of tasks in parallel") {
+    static constexpr int kNumTasks = 2000;
+
+    auto add_all = [](auto&& add_schedule) {
+        for (auto i = 0; i < kNumTasks; i++) {
+            auto expr = i % 100 == 99 ? std::string("+ * * * * ?") : std::format("{} */{} * * * ?", i % 60, i % 7 + 1);
+            add_schedule(std::format("Task {}", i), expr, [](auto) {});
+        }
+    };
+
+    // Tasks due at the same time may be queued in any order.
+    auto sorted_status = [](const auto& scheduler) {
+        auto status = scheduler.GetTasksStatus();
+        std::ranges::sort(status);
+        return status;
+    };
+
+    auto test = [&add_all, &sorted_status](auto& parallel) {
+        Scheduler<TestClock> serial;
+        serial.GetClock().SetTime(sys_days{2024y / 1 / 1});
+        parallel.GetClock().SetTime(sys_days{2024y / 1 / 1});
+
+        REQUIRE(serial.AddSchedule("Existing", "30 * * * * ?", [](auto) {}));
+        REQUIRE(parallel.AddSchedule("Existing", "30 * * * * ?", [](auto) {}));
+        REQUIRE(serial.AddScheduleBatch(add_all));
+        REQUIRE(parallel.AddScheduleBatchParallel(add_all, kNumTasks, 4));
+
+        REQUIRE_EQ(parallel.GetNumTasks(), kNumTasks - kNumTasks / 100 + 1);
+        REQUIRE_EQ(sorted_status(parallel), sorted_status(serial));
+
+        serial.GetClock().Advance(-hours{5});
+        parallel.GetClock().Advance(-hours{5});
+        serial.RecalculateSchedules();
+        serial.SetRecalculationBudget(kNumTasks);
+        serial.Tick();
+        parallel.RecalculateSchedulesParallel(4);
+        REQUIRE_EQ(parallel.TimeUntilNext(), serial.TimeUntilNext());
+        REQUIRE_EQ(sorted_status(parallel), sorted_status(serial));
+    };
+
+    GIVEN("A parser that can be shared between threads") {
+        Scheduler<TestClock, std::mutex, CachedExpressionParser<std::mutex>> scheduler;
+        test(scheduler);
+    }
+    GIVEN("A parser that can not be shared between threads") {
+        Scheduler<TestClock, NullMutex, CachedExpressionParser<NullMutex>> scheduler;
+        test(scheduler);
+    }
+    GIVEN("Only invalid schedules") {
+        Scheduler<TestClock> scheduler;
+        REQUIRE_FALSE(scheduler.AddScheduleBatchParallel([](auto add) { add("invalid", "+ * * * * ?", [](auto) {}); }));
+    }
+    GIVEN("A parser that throws on a worker thread") {
+        Scheduler<TestClock, std::mutex, ThrowingParser> scheduler;
+        auto add_with_failure = [&add_all](auto add_schedule) {
+            add_schedule("First", "throw", [](auto) {});
+            add_all(add_schedule);
+        };
+        THEN("The exception reaches the caller and nothing is added") {
+            REQUIRE_THROWS_AS(scheduler.AddScheduleBatchParallel(add_with_failure, kNumTasks + 1, 4),
+                              std::runtime_error);
+            REQUIRE_EQ(scheduler.GetNumTasks(), 0);
+        }
+    }
+}
+
+TEST_CASE("Randomized schedules") {
+    auto start = sys_days{2024y / 1 / 1};
+    auto replay = [start](std::string_view expression, hours span, minutes skipped = 0min) {
+        Scheduler<TestClock> sched{};
+        sched.GetClock().SetTime(start + skipped);
+        std::vector<TimePoint> runs;
+        REQUIRE(sched.AddRandomizedSchedule("Backup", expression, [&runs](TaskInfo info) {
+            runs.push_back(info.scheduled);
+        }));
+        // Up to the end of the span, an occurrence right at its end belongs to the next one.
+        sched.TickUntil(start + span - 1s);
+        return runs;
+    };
+
+    GIVEN("A random minute") {
+        auto runs = replay("0 R(0-59) * * * ?", hours{48});
+        THEN("It runs once per hour, at another minute from hour to hour") {
+            REQUIRE(runs.size() == 48);
+            std::set<long> minutes;
+            for (std::size_t i = 0; i < runs.size(); ++i) {
+                auto dt = Schedule::ToCalendarTime(runs[i]);
+                REQUIRE(floor<hours>(runs[i]) == start + hours{i});
+                REQUIRE(dt.sec == 0);
+                minutes.insert(dt.min);
+            }
+            REQUIRE(minutes.size() > 10);
+        }
+    }
+    GIVEN("A random hour") {
+        auto runs = replay("0 0 R(0-23) * * ?", days{30});
+        THEN("It runs once per day") {
+            REQUIRE(runs.size() == 30);
+            for (std::size_t i = 0; i < runs.size(); ++i) REQUIRE(floor<days>(runs[i]) == start + days{i});
+        }
+    }
+    GIVEN("A random weekday") {
+        auto runs = replay("0 0 12 ? * R(0-6)", days{7 * 10});
+        THEN("It runs once per week") {
+            // Weeks start on Sunday, 2024-01-01 is a Monday.
+            std::set<long> weeks;
+            for (auto run : runs) weeks.insert((floor<days>(run) - (start - days{1})).count() / 7);
+            REQUIRE(weeks.size() == runs.size());
+            REQUIRE(runs.size() >= 9);
+        }
+    }
+    GIVEN("The same task on two schedulers") {
+        THEN("Both draw the same occurrences") {
+            REQUIRE(replay("0 R(0-59) R(0-23) * * ?", days{10}) == replay("0 R(0-59) R(0-23) * * ?", days{10}));
+        }
+    }
+    GIVEN("The same task on a scheduler that starts several periods later") {
+        auto all = replay("0 R(0-59) R(0-23) * * ?", days{10});
+        auto later = replay("0 R(0-59) R(0-23) * * ?", days{10}, days{3});
+        auto late = replay("0 R(0-59) * * * ?", hours{10});
+        auto mid_period = replay("0 R(0-59) * * * ?", hours{10}, 4h + 30min);
+
+        THEN("It draws the same occurrences for the periods both run") {
+            REQUIRE(later.size() == 7);
+            REQUIRE(std::ranges::equal(later, std::span(all).last(7)));
+        }
+        THEN("A draw that passed before it started is not run") {
+            std::vector<TimePoint> expected;
+            std::ranges::copy_if(late, std::back_inserter(expected),
+                                 [start](TimePoint run) { return run >= start + 4h + 30min; });
+            REQUIRE(mid_period == expected);
+        }
+    }
+    GIVEN("A fixed name and hash seed") {
+        auto runs = replay("0 R(0-59) R(0-23) * * ?", days{3});
+        THEN("Every platform draws the same occurrences") {
+            std::vector<TimePoint> expected{start + 9h + 11min, start + days{1} + 12h + 2min,
+                                            start + days{2} + 9h + 41min};
+            REQUIRE(runs == expected);
+        }
+    }
+    GIVEN("A copy of a randomized task") {
+        auto pattern = RandomizationTemplate::Parse("0 R(0-59) * * * ?");
+        REQUIRE(pattern);
+        Task task("Backup", Schedule(pattern->GetMasks()), [](TaskInfo) {});
+        REQUIRE(task.SetRandomization(std::make_shared<const RandomizationTemplate>(*pattern), MakeHashKey("Backup")));
+        auto copy = task;
+
+        THEN("Both draw the same periods on their own") {
+            for (auto from = TimePoint{start}; from < start + 10h; from += 1h) {
+                REQUIRE(task.CalculateNext(from));
+                REQUIRE(copy.CalculateNext(from));
+                REQUIRE_EQ(task.GetNextSchedule(), copy.GetNextSchedule());
+            }
+        }
+    }
+    GIVEN("A task restored from a snapshot") {
+        auto path = std::filesystem::temp_directory_path() / "chron_randomized_snapshot_test.bin";
+        auto expression = "0 R(0-59) * * * ?";
+        auto stop = start + 4h + 30min;
+
+        std::vector<TimePoint> runs;
+        auto record = [&runs](TaskInfo info) { runs.push_back(info.scheduled); };
+        {
+            Scheduler<TestClock> sched{};
+            sched.GetClock().SetTime(start);
+            REQUIRE(sched.AddRandomizedSchedule("Backup", expression, record));
+            sched.TickUntil(stop);
+            REQUIRE(sched.SaveSnapshot(path));
+        }
+        Scheduler<TestClock> sched{};
+        sched.GetClock().SetTime(stop);
+        REQUIRE(sched.RestoreSnapshot(path, [&record](std::string_view) -> TaskFn { return record; }) == 1);
+        auto restored = runs.size();
+        sched.TickUntil(start + 10h - 1s);
+        std::filesystem::remove(path);
+
+        THEN("It keeps drawing for every period as if it never stopped") {
+            REQUIRE(runs == replay(expression, hours{10}));
+            std::set<long> minutes;
+            for (auto i = restored; i < runs.size(); ++i) minutes.insert(Schedule::ToCalendarTime(runs[i]).min);
+            REQUIRE(minutes.size() > 1);
+        }
+    }
+    GIVEN("Invalid expressions") {
+        Scheduler<TestClock> sched{};
+        THEN("They are rejected") {
+            REQUIRE_FALSE(sched.AddRandomizedSchedule("Invalid", "0 R(0-99) * * * ?", [](TaskInfo) {}));
+            REQUIRE_FALSE(sched.AddRandomizedSchedule("Invalid", "0 R(0-59) * * *", [](TaskInfo) {}));
+        }
+    }
+}
+
+TEST_CASE("Placing randomized schedules by load") {
+    auto start = sys_days{2024y / 1 / 1};
+    Scheduler<TestClock> sched{};
+    sched.GetClock().SetTime(start);
+    sched.SetLoadAwarePlacement(true);
+    const auto* occupancy = sched.GetOccupancy();
+    REQUIRE(occupancy);
+
+    REQUIRE(sched.AddSchedule("Fixed", "0 0 * * * ?", [](TaskInfo) {}));
+    for (int i = 0; i < 59; ++i) {
+        REQUIRE(sched.AddRandomizedSchedule(std::format("Task {}", i), "R(0-59) 0 * * * ?", [](TaskInfo) {}));
+    }
+    auto count_seconds = [occupancy](uint32_t n) { return std::ranges::count(occupancy->GetSeconds(), n); };
+
+    THEN("Every task gets a second of its own") {
+        REQUIRE_EQ(count_seconds(1), 60);
+        REQUIRE_EQ(occupancy->GetMinutes()[0], 60);
+    }
+    THEN("Redraws and expired tasks keep the counts up to date") {
+        REQUIRE(sched.AddSchedule("Once", "15 0 0 1 1 ? 2024", [](TaskInfo) {}));
+        REQUIRE_EQ(occupancy->GetSeconds()[15], 2);
+        REQUIRE_EQ(sched.TickUntil(start + 5h + 30min), 60 * 6 + 1);
+        REQUIRE_EQ(sched.GetNumTasks(), 60);
+        // Each task holds one second, a redraw next to the expiring task may have picked a shared one.
+        const auto& seconds = occupancy->GetSeconds();
+        REQUIRE_EQ(std::accumulate(seconds.begin(), seconds.end(), 0u), 60);
+        REQUIRE_EQ(occupancy->GetMinutes()[0], 60);
+    }
+    THEN("Removed and replaced tasks free their seconds") {
+        REQUIRE(occupancy->GetSeconds()[0] == 1);
+        sched.RemoveSchedule("Fixed");
+        REQUIRE_EQ(occupancy->GetSeconds()[0], 0);
+        REQUIRE(sched.AddRandomizedSchedule("Late", "R(0-59) 0 * * * ?", [](TaskInfo) {}));
+        REQUIRE_EQ(count_seconds(1), 60);
+
+        sched.UpdateSchedules({}, [](auto add_schedule) { add_schedule("Late", "0 0 * * * ?", [](TaskInfo) {}); });
+        REQUIRE_EQ(count_seconds(1), 60);
+        sched.ClearSchedules();
+        REQUIRE_EQ(count_seconds(0), 60);
+        REQUIRE_EQ(occupancy->GetMinutes()[0], 0);
+    }
+    THEN("Turning it off forgets the counts") {
+        sched.SetLoadAwarePlacement(false);
+        REQUIRE_FALSE(sched.GetOccupancy());
+        sched.SetLoadAwarePlacement(true);
+        REQUIRE_EQ(std::ranges::count(sched.GetOccupancy()->GetSeconds(), 1u), 60);
+    }
+}
+
+TEST_CASE("Dispersing tasks with the same schedule") {
+    struct Run {
+        std::string name;
+        TimePoint scheduled;
+        Duration delay;
+        TimePoint at;
+    };
+
+    Scheduler<TestClock> sched{};
+    auto& clock = sched.GetClock();
+    TimePoint start = sys_days{2024y / 1 / 1} + 30min;
+    clock.SetTime(start);
+    sched.SetDispersionWindow(10min);
+
+    std::vector<Run> runs;
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(sched.AddSchedule(std::format("Task {}", i), "0 0 * * * ?", [&](TaskInfo info) {
+            runs.emplace_back(std::string(info.name), info.scheduled, info.delay, clock.Now());
+        }));
+    }
+    auto top = start + 30min;
+
+    THEN("The runs are spread over the window, each at its own offset") {
+        REQUIRE(sched.TimeUntilNext() >= 30min);
+        clock.SetTime(top - 1s);
+        REQUIRE(sched.Tick() == 0);
+
+        for (auto now = top; now < top + 10min; now += 1s) {
+            clock.SetTime(now);
+            sched.Tick();
+            // Nothing is due before the next run, so a tick thread can sleep until then.
+            REQUIRE(sched.TimeUntilNext() > 0s);
+        }
+        REQUIRE(runs.size() == 100);
+        REQUIRE(std::ranges::is_sorted(runs, {}, &Run::at));
+        REQUIRE(runs.back().at - runs.front().at > 5min);
+
+        std::set<std::string> names;
+        for (const auto& run : runs) {
+            REQUIRE(run.scheduled == top);
+            REQUIRE(run.delay == 0s);
+            names.insert(run.name);
+        }
+        REQUIRE(names.size() == 100);
+    }
+    THEN("Each task keeps its offset for every occurrence") {
+        for (auto now = top; now < top + 2h + 10min; now += 1s) {
+            clock.SetTime(now);
+            sched.Tick();
+        }
+        REQUIRE(runs.size() == 300);
+        std::map<std::string, Duration> offsets;
+        for (const auto& run : runs) {
+            auto it = offsets.try_emplace(run.name, run.at - run.scheduled).first;
+            REQUIRE(it->second == run.at - run.scheduled);
+        }
+        REQUIRE(offsets.size() == 100);
+    }
+    THEN("Another scheduler with the same seed disperses a task alike") {
+        Scheduler<TestClock> other{};
+        other.GetClock().SetTime(start);
+        other.SetDispersionWindow(10min);
+        REQUIRE(other.AddSchedule("Task 7", "0 0 * * * ?", [](TaskInfo) {}));
+        for (auto now = top; now < top + 10min; now += 1s) {
+            clock.SetTime(now);
+            sched.Tick();
+        }
+        auto run = std::ranges::find(runs, std::string("Task 7"), &Run::name);
+        REQUIRE(run != runs.end());
+        REQUIRE(start + other.TimeUntilNext() == run->at);
+    }
+}
@@ -0,0 +1,169 @@
+#include "doctest.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <oryx/chron/parser.hpp>
+#include <oryx/chron/scheduler.hpp>
+#include <oryx/chron/snapshot.hpp>
+
+using namespace oryx::chron;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct ManualClock {
+    auto Now() const -> TimePoint { return now; }
+    auto UtcOffset(TimePoint) const -> std::chrono::seconds { return std::chrono::seconds{0}; }
+
+    TimePoint now{};
+};
+
+auto MakeTime(int hour, int minute, int second) -> TimePoint {
+    return std::chrono::sys_days{std::chrono::year{2024} / 3 / 1} + std::chrono::hours{hour} +
+           std::chrono::minutes{minute} + std::chrono::seconds{second};
+}
+
+}  // namespace
+
+TEST_CASE("Snapshots") {
+    GIVEN("A scheduler that ran for a while") {
+        auto path = std::filesystem::temp_directory_path() / "chron_snapshot_test.bin";
+
+        Scheduler<ManualClock> scheduler;
+        scheduler.GetClock().now = MakeTime(12, 0, 0);
+        std::vector<std::string> runs;
+        auto record = [&runs](TaskInfo info) { runs.emplace_back(info.name); };
+
+        REQUIRE(scheduler.AddSchedule("minutely", "0 * * * * ?", record));
+        REQUIRE(scheduler.AddSchedule("hourly", "0 0 * * * ?", record));
+        REQUIRE(scheduler.AddSchedule("also-minutely", "0 * * * * ?", record));
+        REQUIRE(scheduler.SetMisfirePolicy("hourly", MisfirePolicy{.action = MisfireAction::Skip}));
+        REQUIRE_EQ(scheduler.Tick(MakeTime(12, 1, 0)), 2);
+
+        REQUIRE(scheduler.SaveSnapshot(path));
+
+        WHEN("Opening the snapshot") {
+            auto snapshot = Snapshot::Open(path);
+            REQUIRE(snapshot);
+
+            THEN("All tasks are there in queue order") {
+                REQUIRE_EQ(snapshot->GetSize(), 3);
+                REQUIRE_EQ(snapshot->GetLastTick(), MakeTime(12, 1, 0));
+
+                std::vector<SnapshotTask> tasks;
+                snapshot->ForEach([&tasks](const SnapshotTask& task) { tasks.push_back(task); });
+                REQUIRE_EQ(tasks[2].name, "hourly");
+                REQUIRE_EQ(tasks[2].expression, "0 0 * * * ?");
+                REQUIRE(tasks[2].time_zone.empty());
+                REQUIRE_EQ(tasks[2].next_schedule, MakeTime(13, 0, 0));
+                REQUIRE(tasks[2].valid);
+                REQUIRE(tasks[2].misfire_policy);
+                REQUIRE_EQ(tasks[2].misfire_policy->action, MisfireAction::Skip);
+                REQUIRE_EQ(tasks[0].masks, tasks[1].masks);
+                REQUIRE_EQ(tasks[0].next_schedule, MakeTime(12, 2, 0));
+                REQUIRE_EQ(tasks[0].last_run, MakeTime(12, 1, 59));
+                REQUIRE_FALSE(tasks[0].misfire_policy);
+            }
+        }
+
+        WHEN("Restoring it into another scheduler") {
+            Scheduler<ManualClock> restored;
+            restored.GetClock().now = MakeTime(12, 1, 30);
+            REQUIRE(restored.AddSchedule("replaced", "* * * * * ?", record));
+
+            auto count = restored.RestoreSnapshot(path, [&record](std::string_view name) -> TaskFn {
+                if (name == "also-minutely") return nullptr;
+                return record;
+            });
+
+            THEN("Tasks with a function continue where they left off") {
+                REQUIRE(count);
+                REQUIRE_EQ(count.value(), 2);
+                REQUIRE_EQ(restored.GetNumTasks(), 2);
+                REQUIRE_EQ(restored.TimeUntilNext(), 30s);
+
+                runs.clear();
+                REQUIRE_EQ(restored.Tick(MakeTime(12, 2, 0)), 1);
+                REQUIRE_EQ(restored.TickUntil(MakeTime(13, 0, 0)), 59);
+                REQUIRE_EQ(std::ranges::count(runs, "hourly"), 1);
+            }
+
+            AND_WHEN("Saving the restored scheduler again") {
+                REQUIRE(restored.SaveSnapshot(path));
+                auto snapshot = Snapshot::Open(path);
+                REQUIRE(snapshot);
+
+                THEN("The expression text is kept") {
+                    REQUIRE_EQ(snapshot->GetSize(), 2);
+                    REQUIRE_EQ(snapshot->GetTask(1).expression, "0 0 * * * ?");
+                }
+            }
+        }
+
+        WHEN("The snapshot is damaged") {
+            auto size = std::filesystem::file_size(path);
+            std::filesystem::resize_file(path, size - 1);
+
+            THEN("It is rejected and the scheduler is left alone") {
+                REQUIRE_FALSE(Snapshot::Open(path));
+                Scheduler<ManualClock> restored;
+                REQUIRE(restored.AddSchedule("kept", "* * * * * ?", record));
+                REQUIRE_FALSE(restored.RestoreSnapshot(path, [&record](std::string_view) -> TaskFn { return record; }));
+                REQUIRE_EQ(restored.GetNumTasks(), 1);
+            }
+        }
+
+        WHEN("The file is something else") {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << std::string(256, 'x');
+
+            THEN("It is rejected") { REQUIRE_FALSE(Snapshot::Open(path)); }
+        }
+
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_CASE("Schedule tables") {
+    GIVEN("A table compiled ahead of time") {
+        auto path = std::filesystem::temp_directory_path() / "chron_schedule_table_test.bin";
+
+        SnapshotWriter writer;
+        for (auto [name, expression] : {std::pair{"backup", "0 0 2 * * ?"}, std::pair{"report", "0 30 6 * * ?"},
+                                        std::pair{"nightly", "0 0 2 * * ?"}}) {
+            writer.Add({.name = name,
+                        .expression = expression,
+                        .time_zone = {},
+                        .masks = ChronMasks(kParseExpression(expression).value()),
+                        .next_schedule = {},
+                        .last_run = {},
+                        .delay = {},
+                        .valid = false,
+                        .misfire_policy = {}});
+        }
+        REQUIRE_EQ(writer.GetNumSchedules(), 2);
+        REQUIRE(writer.Write(path, TimePoint{}));
+
+        WHEN("Adding it to a scheduler") {
+            Scheduler<ManualClock> scheduler;
+            scheduler.GetClock().now = MakeTime(12, 30, 0);
+            REQUIRE(scheduler.AddSchedule("existing", "0 0 * * * ?", [](auto) {}));
+
+            auto count = scheduler.AddScheduleTable(path, [](std::string_view) -> TaskFn { return [](auto) {}; });
+
+            THEN("First runs are calculated from the current time") {
+                REQUIRE(count);
+                REQUIRE_EQ(count.value(), 3);
+                REQUIRE_EQ(scheduler.GetNumTasks(), 4);
+                REQUIRE_EQ(scheduler.TimeUntilNext(), 30min);
+                REQUIRE_EQ(scheduler.TickUntil(MakeTime(12, 30, 0) + 24h), 24 + 3);
+            }
+        }
+
+        std::filesystem::remove(path);
+    }
+}
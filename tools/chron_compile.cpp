@@ -0,0 +1,80 @@
+// Compiles crontab files into a schedule table, which `Scheduler::AddScheduleTable` loads without parsing anything.
+//
+//     chron-compile <output> <crontab>...
+//
+// Every expression is validated and stored in its canonical form, identical schedules are stored once. Nothing is
+// written if any entry is invalid or a task name is used twice. `H` fields are derived from the task name with the
+// default seed of the scheduler.
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include <oryx/chron/crontab.hpp>
+#include <oryx/chron/parser.hpp>
+#include <oryx/chron/snapshot.hpp>
+
+using namespace oryx::chron;
+
+auto main(int argc, char** argv) -> int {
+    if (argc < 3) {
+        std::cerr << "usage: chron-compile <output> <crontab>...\n";
+        return 2;
+    }
+
+    SnapshotWriter writer;
+    std::unordered_set<std::string> names;
+    std::size_t num_errors{};
+
+    for (int i = 2; i < argc; ++i) {
+        std::string_view file = argv[i];
+        auto crontab = Crontab::Open(file);
+        if (!crontab) {
+            std::cerr << file << ": can not open file\n";
+            ++num_errors;
+            continue;
+        }
+
+        crontab->ForEach([&](const Crontab::Entry& entry) {
+            auto report = [&](std::string_view message) {
+                std::cerr << file << ":" << entry.line << ": " << message << "\n";
+                ++num_errors;
+            };
+
+            if (entry.expression.empty()) {
+                return report("missing expression");
+            }
+            auto data = kParseExpression(entry.expression, MakeHashKey(entry.name));
+            if (!data) {
+                return report("invalid expression '" + std::string(entry.expression) + "'");
+            }
+            if (!names.emplace(entry.name).second) {
+                return report("duplicate task '" + std::string(entry.name) + "'");
+            }
+
+            // Run state is left empty, it is calculated when the table is loaded.
+            writer.Add({.name = entry.name,
+                        .expression = data->ToCanonicalString(),
+                        .time_zone = {},
+                        .masks = ChronMasks(data.value()),
+                        .next_schedule = {},
+                        .last_run = {},
+                        .delay = {},
+                        .valid = false,
+                        .misfire_policy = {}});
+        });
+    }
+
+    if (num_errors > 0) {
+        std::cerr << num_errors << " error(s), nothing written\n";
+        return 1;
+    }
+    if (!writer.Write(argv[1], TimePoint{})) {
+        std::cerr << argv[1] << ": can not write file\n";
+        return 1;
+    }
+
+    std::cout << names.size() << " tasks, " << writer.GetNumSchedules() << " distinct schedules\n";
+    return 0;
+}